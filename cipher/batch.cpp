@@ -0,0 +1,103 @@
+#include "batch.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "file_ops.h"
+#include "scramble.h"
+
+int read_manifest(std::vector<batch_job> & jobs, std::string path_to_file)
+{
+    std::ifstream input(path_to_file);
+    if (!input.is_open()) {
+        spdlog::error("Error opening manifest to read from: {}", path_to_file);
+        return 1;
+    }
+    std::string line;
+    for (size_t line_number = 1; std::getline(input, line); line_number++) {
+        std::istringstream fields(line);
+        std::string direction;
+        if (!(fields >> direction) || direction[0] == '#') { continue; }
+        batch_job job;
+        std::string extra;
+        if ((direction != "encode" && direction != "decode")
+            || !(fields >> job.input_file_path >> job.output_file_path >> job.key_file_path)
+            || (fields >> extra)) {
+            spdlog::error("{}:{}: expected encode|decode <input file> <output file> <key file>", path_to_file, line_number);
+            return 1;
+        }
+        job.encode = direction == "encode";
+        jobs.push_back(job);
+    }
+    return 0;
+}
+
+int pack_batch(const std::vector<batch_job> & jobs, batch & packed)
+{
+    constexpr auto decimal_begin{0};
+    constexpr auto decimal_end{256};
+
+    // byte maps :: begin
+    // note: Each key file is read once, and each (key file, direction) pair gets one map in the table.
+    std::map<std::pair<std::string, bool>, uint32_t> map_of_key;
+    std::vector<std::byte> key;
+    packed.job_map.resize(jobs.size());
+    for (size_t j = 0; j < jobs.size(); j++) {
+        const auto found = map_of_key.find({jobs[j].key_file_path, jobs[j].encode});
+        if (found != map_of_key.end()) {
+            packed.job_map[j] = found->second;
+            continue;
+        }
+        if (read_from_binary(key, jobs[j].key_file_path) == 1) { return 1; }
+        const auto m = static_cast<uint32_t>(map_of_key.size());
+        packed.byte_maps.resize(decimal_end * (m + 1));
+        std::byte * const byte_map = packed.byte_maps.data() + decimal_end * m;
+        if (jobs[j].encode) {
+            scramble_into(key.data(), key.size(), decimal_begin, decimal_end, byte_map);
+        }
+        else {
+            unscramble_into(key.data(), key.size(), decimal_begin, decimal_end, byte_map);
+        }
+        map_of_key.emplace(std::pair{jobs[j].key_file_path, jobs[j].encode}, m);
+        packed.job_map[j] = m;
+    }
+    // byte maps :: end
+
+    // input messages :: begin
+    // note: The sizes come first, so that the messages are read straight into one allocation.
+    packed.job_begin.assign(jobs.size() + 1, 0);
+    for (size_t j = 0; j < jobs.size(); j++) {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(jobs[j].input_file_path, error);
+        if (error) {
+            spdlog::error("Error opening file to read from: {}", jobs[j].input_file_path);
+            return 1;
+        }
+        packed.job_begin[j + 1] = packed.job_begin[j] + size;
+    }
+    packed.messages.resize(packed.job_begin.back());
+    for (size_t j = 0; j < jobs.size(); j++) {
+        std::ifstream input(jobs[j].input_file_path, std::ios::binary);
+        const auto size = packed.job_begin[j + 1] - packed.job_begin[j];
+        if (!input.is_open() || !input.read(reinterpret_cast<char*>(packed.messages.data() + packed.job_begin[j]), size)) {
+            spdlog::error("Error reading from file: {}", jobs[j].input_file_path);
+            return 1;
+        }
+    }
+    // input messages :: end
+    return 0;
+}
+
+int write_batch(const std::vector<batch_job> & jobs, const batch & packed, const std::byte * output_messages)
+{
+    for (size_t j = 0; j < jobs.size(); j++) {
+        const auto size = packed.job_begin[j + 1] - packed.job_begin[j];
+        if (write_to_binary(output_messages + packed.job_begin[j], size, jobs[j].output_file_path) == 1) { return 1; }
+    }
+    return 0;
+}
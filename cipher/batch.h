@@ -0,0 +1,69 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// struct batch_job
+// ----------------
+// description: One line of a batch manifest: encode|decode <input file> <output file> <key file>
+//
+struct batch_job
+{
+    bool encode{true};
+    std::string input_file_path;
+    std::string output_file_path;
+    std::string key_file_path;
+};
+
+// struct batch
+// ------------
+// description: All jobs of a manifest packed for a single kernel.
+// The input messages are concatenated, and the byte maps are packed into one 256 x K table,
+// with one map per distinct (key file, encode/decode) pair, so that jobs sharing a key share its map.
+//
+struct batch
+{
+    std::vector<std::byte> messages;
+    std::vector<std::byte> byte_maps;   // map m is byte_maps[256 * m, 256 * m + 256)
+    std::vector<uint32_t> job_map;      // map of each job
+    std::vector<size_t> job_begin;      // offset of each job's message in messages, and the total size at the end
+};
+
+// function read_manifest
+// ----------------------
+// inputs: the jobs to fill and the path to the manifest, with one job per line:
+//         encode|decode <input file> <output file> <key file>
+//         (paths without spaces, relative to the working directory; empty lines and # comments are skipped)
+//
+// output: Returns 1 if the manifest cannot be opened or a line is malformed (reported with its line number), else 0.
+//
+int read_manifest(
+    std::vector<batch_job> & jobs,
+    std::string path_to_file
+);
+
+// function pack_batch
+// -------------------
+// description: Reads every key file once and every input file, builds the byte maps and fills packed.
+// Returns 1 if a file cannot be read, else 0.
+//
+int pack_batch(
+    const std::vector<batch_job> & jobs,
+    batch & packed
+);
+
+// function write_batch
+// --------------------
+// description: Writes the output message of each job (its slice of output_messages) to its output file.
+// Returns 1 if a file cannot be written, else 0.
+//
+int write_batch(
+    const std::vector<batch_job> & jobs,
+    const batch & packed,
+    const std::byte * output_messages
+);
+
+#endif
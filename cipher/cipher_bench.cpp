@@ -0,0 +1,279 @@
+#include <sycl/sycl.hpp>
+#include <dpc_common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <random>
+
+#include <CLI/CLI.hpp>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "scramble.h"
+#include "substitute.h"
+#include "substitute_simd.h"
+#include "timestamps.h"
+#include "plf_nanotimer.h"
+
+// byte substitution throughput on synthetic messages from 1 KB up to several GB:
+// sweeps the message size, key length, number of byte maps (polyalphabetic period), engine and grain size,
+// and reports bytes/s at the minimum, median and 99th percentile time over the repetitions
+// as label,value rows like print_timestamps
+
+// function generate_message
+// -------------------------
+// description: Fills message with random bytes or with text-like bytes
+// (common English words separated by spaces, with some punctuation and line breaks).
+//
+void generate_message(std::vector<std::byte> & message, const std::string & kind, std::mt19937_64 & generator)
+{
+    if (kind == "random") {
+        size_t i = 0;
+        for (; i + 8 <= message.size(); i += 8) {
+            const auto bits = generator();
+            std::memcpy(message.data() + i, &bits, 8);
+        }
+        for (; i < message.size(); i++) {
+            message[i] = static_cast<std::byte>(generator());
+        }
+        return;
+    }
+    static const std::vector<std::string> words{
+        "the", "of", "and", "to", "a", "in", "that", "he", "was", "it", "his", "is", "with", "as", "had",
+        "for", "which", "on", "not", "her", "by", "this", "at", "be", "you", "from", "but", "they", "all",
+        "one", "bishop", "man", "there", "have", "said", "what", "were", "no", "would", "been", "night",
+        "so", "who", "Valjean", "Paris", "into", "little", "door", "an", "upon", "street", "time", "moment"
+    };
+    size_t i = 0;
+    while (i < message.size()) {
+        const auto & word = words[generator() % words.size()];
+        for (size_t k = 0; k < word.size() && i < message.size(); k++) {
+            message[i++] = static_cast<std::byte>(word[k]);
+        }
+        if (i < message.size()) {
+            const auto r = generator() % 40;
+            message[i++] = static_cast<std::byte>(r == 0 ? '\n' : r == 1 ? '.' : r == 2 ? ',' : ' ');
+        }
+    }
+}
+
+// struct sample_stats
+// -------------------
+// description: Minimum, median and 99th percentile (nearest rank) of the times of the repetitions.
+//
+struct sample_stats
+{
+    double min;
+    double median;
+    double p99;
+};
+
+sample_stats summarize(std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    const auto n = times.size();
+    const auto median = n % 2 == 1 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    const auto p99 = times[static_cast<size_t>(std::ceil(0.99 * n)) - 1];
+    return sample_stats{times.front(), median, p99};
+}
+
+int main(const int argc, const char *const argv[])
+{
+    size_t min_size{1 << 10};
+    size_t max_size{64 << 20};
+    size_t size_step{8};
+    std::string data_kind{"random"};
+    std::vector<size_t> key_sizes{16, 256};
+    std::vector<size_t> periods{0, 16};
+    std::vector<std::string> engines{"sequential", "simd", "sycl", "sycl-global"};
+    std::vector<uint> grain_sizes{1, 100, 10000};
+    uint repetitions{10};
+    size_t work_group_size{256};
+    bool run_cpuonly{false};
+    std::vector<std::tuple<std::string, double>> timestamps;
+    double time_result;
+
+    CLI::App app{"Byte substitution benchmark"};
+    app.option_defaults()->always_capture_default(true);
+    app.add_option("--min-size", min_size, "smallest message in bytes")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("--max-size", max_size, "largest message in bytes (e.g., 8589934592 for 8 GB: needs three times that in host memory, plus the device buffers)")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("--size-step", size_step, "factor between consecutive message sizes")
+        ->check(CLI::Range(2, 1024));
+    app.add_option("--data", data_kind, "synthetic message: random bytes or text-like words")
+        ->check(CLI::IsMember(std::vector<std::string>{"random", "text"}));
+    app.add_option("-k, --key-sizes", key_sizes, "sizes of the random keys in bytes")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("-P, --periods", periods, "numbers of byte maps (0: one byte map, else polyalphabetic)");
+    app.add_option("-e, --engines", engines, "sequential (substitute), simd (substitute_simd), sycl (byte maps in local memory), sycl-global (byte maps in global memory)")
+        ->check(CLI::IsMember(std::vector<std::string>{"sequential", "simd", "sycl", "sycl-global"}));
+    app.add_option("-g, --grainsizes", grain_sizes, "grain sizes of the sequential and sycl engines")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("-r, --repetitions", repetitions, "timed repetitions per configuration (after one warm-up run)")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("--work-group-size", work_group_size, "work items per work-group of the nd_range kernels")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_flag("-c, --cpu-only", run_cpuonly);
+    CLI11_PARSE(app, argc, argv);
+
+    // sycl Q creation :: begin
+    // note: Only when a sycl engine is requested.
+    const bool use_device = std::any_of(engines.begin(), engines.end(), [](const auto & engine) { return engine.rfind("sycl", 0) == 0; });
+    std::optional<sycl::queue> Q;
+    size_t local_mem_size{0};
+    if (use_device) {
+        sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+        Q.emplace(device, dpc_common::exception_handler, sycl::property_list{sycl::property::queue::enable_profiling{}});
+        spdlog::info("Device: {}", Q->get_device().get_info<sycl::info::device::name>());
+        work_group_size = std::min<size_t>(work_group_size, Q->get_device().get_info<sycl::info::device::max_work_group_size>());
+        local_mem_size = Q->get_device().get_info<sycl::info::device::local_mem_size>();
+    }
+    spdlog::info("host simd engine: {}", simd_instruction_set());
+    // sycl Q creation :: end
+
+    std::mt19937_64 generator{42};
+    for (size_t size = min_size; size <= max_size; size *= size_step) {
+        // synthetic message :: begin
+        spdlog::info("generating {} message of {} bytes", data_kind, size);
+        std::vector<std::byte> message(size);
+        std::vector<std::byte> output(size);
+        std::vector<std::byte> expected(size);
+        generate_message(message, data_kind, generator);
+        std::optional<sycl::buffer<std::byte>> message_buf;
+        std::optional<sycl::buffer<std::byte>> output_buf;
+        if (use_device) {
+            message_buf.emplace(message.data(), sycl::range<1>{size});
+            output_buf.emplace(sycl::range<1>{size});
+        }
+        // synthetic message :: end
+
+        for (const auto key_size : key_sizes) {
+            std::vector<std::byte> key(key_size);
+            for (auto & b : key) { b = static_cast<std::byte>(generator()); }
+
+            for (const auto period : periods) {
+                // byte maps and expected output :: begin
+                std::vector<std::byte> byte_maps = period > 0 ? scramble_polyalphabetic(key, period) : scramble(key, 0, 256);
+                constexpr uint expected_grain_size{1 << 20};
+                for (size_t i = 0; i < size / expected_grain_size + 1; i++) {
+                    if (period > 0) {
+                        substitute_periodic(byte_maps, period, message, expected, size, expected_grain_size, i);
+                    }
+                    else {
+                        substitute<decltype(byte_maps)>(byte_maps, message, expected, size, expected_grain_size, i);
+                    }
+                }
+                std::optional<sycl::buffer<std::byte>> byte_maps_buf;
+                if (use_device) {
+                    byte_maps_buf.emplace(byte_maps.data(), sycl::range<1>{byte_maps.size()});
+                }
+                // byte maps and expected output :: end
+
+                for (const auto & engine : engines) {
+                    if (engine == "simd" && period > 0) { continue; }
+                    if (engine == "sycl" && byte_maps.size() > local_mem_size) {
+                        spdlog::info("{} byte maps do not fit into {} bytes of local memory", period, local_mem_size);
+                        continue;
+                    }
+                    // the simd engine has no grain size
+                    const auto engine_grain_sizes = engine == "simd" ? std::vector<uint>{0} : grain_sizes;
+                    for (const auto grain_size : engine_grain_sizes) {
+                        // one run of the configuration :: begin
+                        // note: The sycl engines return the event of their kernel.
+                        const auto run = [&]() -> std::optional<sycl::event> {
+                            if (engine == "sequential" && period > 0) {
+                                for (size_t i = 0; i < size / grain_size + 1; i++) {
+                                    substitute_periodic(byte_maps, period, message, output, size, grain_size, i);
+                                }
+                            }
+                            else if (engine == "sequential") {
+                                for (size_t i = 0; i < size / grain_size + 1; i++) {
+                                    substitute<decltype(byte_maps)>(byte_maps, message, output, size, grain_size, i);
+                                }
+                            }
+                            else if (engine == "simd") {
+                                substitute_simd(byte_maps, message.data(), output.data(), size);
+                            }
+                            else if (period > 0) {
+                                return submit_substitute_periodic(*Q, *byte_maps_buf, period, *message_buf, *output_buf, size, grain_size, work_group_size, engine == "sycl");
+                            }
+                            else if (engine == "sycl") {
+                                return submit_substitute_tiles(*Q, *byte_maps_buf, *message_buf, *output_buf, size, grain_size, work_group_size);
+                            }
+                            else {
+                                return Q->submit([&](auto & h) {
+                                    const sycl::accessor byte_map_acc{*byte_maps_buf, h, sycl::read_only};
+                                    const sycl::accessor message_acc{*message_buf, h, sycl::read_only};
+                                    const sycl::accessor output_acc{*output_buf, h, sycl::write_only, sycl::no_init};
+                                    h.parallel_for(size / grain_size + 1, [=](const auto & i) {
+                                        substitute<decltype(byte_map_acc)>(byte_map_acc, message_acc, output_acc, size, grain_size, i);
+                                    });
+                                });
+                            }
+                            return std::nullopt;
+                        };
+                        // one run of the configuration :: end
+
+                        // repetitions :: begin
+                        // note: The warm-up run moves the message to the device. The sycl engines are timed
+                        // from command_start to command_end of their kernel, the host engines with the nanotimer.
+                        if (auto event = run()) { event->wait(); }
+                        std::vector<double> times;
+                        for (uint r = 0; r < repetitions; r++) {
+                            plf::nanotimer timer;
+                            timer.start();
+                            auto event = run();
+                            if (event) {
+                                event->wait();
+                                const auto start = event->get_profiling_info<sycl::info::event_profiling::command_start>();
+                                const auto end = event->get_profiling_info<sycl::info::event_profiling::command_end>();
+                                times.push_back(end - start);
+                            }
+                            else {
+                                times.push_back(timer.get_elapsed_ns());
+                            }
+                        }
+                        // repetitions :: end
+
+                        // check output :: begin
+                        bool correct = true;
+                        if (engine.rfind("sycl", 0) == 0) {
+                            const sycl::host_accessor actual{*output_buf};
+                            correct = std::equal(expected.begin(), expected.end(), &actual[0]);
+                        }
+                        else {
+                            correct = output == expected;
+                        }
+                        const auto label = engine == "simd"
+                            ? fmt::format("{} size={} key={} period={}", engine, size, key_size, period)
+                            : fmt::format("{} size={} key={} period={} grain={}", engine, size, key_size, period, grain_size);
+                        if (!correct) {
+                            spdlog::error("wrong output: {}", label);
+                            return 1;
+                        }
+                        // check output :: end
+
+                        // bytes/s at the minimum time (the peak rate), the median time, and the 99th percentile time
+                        // note: No row for a zero time (a device without profiling timestamps).
+                        const auto stats = summarize(times);
+                        const auto mark_rate = [&](const double time, const std::string & statistic) {
+                            if (time == 0) { return; }
+                            time_result = 1e9 * size / time;
+                            mark_time(timestamps, time_result, label + " " + statistic + " bytes/s");
+                        };
+                        mark_rate(stats.min, "max");
+                        mark_rate(stats.median, "median");
+                        mark_rate(stats.p99, "p99-time");
+                    }
+                }
+            }
+        }
+        if (size > max_size / size_step) { break; }
+    }
+
+    print_timestamps(timestamps);
+    return 0;
+}
@@ -1,5 +1,10 @@
 #include "file_ops.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 // If the file cannot be opened, then the function will notify the caller
 // by returning 1.
 int read_from_binary(std::vector<std::byte> & buffer, std::string path_to_file)
@@ -15,4 +20,100 @@ int read_from_binary(std::vector<std::byte> & buffer, std::string path_to_file)
     input.read(reinterpret_cast<char*>(buffer.data()), size);
     input.close();
     return 0;
+}
+
+int write_to_binary(const std::byte * data, size_t size, std::string path_to_file)
+{
+    std::ofstream output(path_to_file, std::ios::binary);
+    if (!output.is_open()) {
+        spdlog::error("Error opening file to write to: {}", path_to_file);
+        return 1;
+    }
+    // TODO: See if it is possible to write binary data to file without casting.
+    output.write(reinterpret_cast<const char*>(data), size);
+    output.close();
+    return 0;
+}
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+void mapped_file::close()
+{
+    if (address != nullptr) {
+        munmap(address, length);
+        address = nullptr;
+    }
+    if (descriptor != -1) {
+        ::close(descriptor);
+        descriptor = -1;
+    }
+    length = 0;
+}
+
+int mapped_file::sync()
+{
+    if (address != nullptr && msync(address, length, MS_SYNC) != 0) {
+        spdlog::error("Error writing mapped file to disk");
+        return 1;
+    }
+    return 0;
+}
+
+// note: Empty files are not mapped (mmap rejects zero lengths); data() is then nullptr and size() is 0.
+int map_for_reading(mapped_file & file, std::string path_to_file)
+{
+    file.close();
+    file.descriptor = open(path_to_file.c_str(), O_RDONLY);
+    struct stat status;
+    if (file.descriptor == -1 || fstat(file.descriptor, &status) != 0) {
+        spdlog::error("Error opening file to read from: {}", path_to_file);
+        file.close();
+        return 1;
+    }
+    file.length = status.st_size;
+    if (file.length > 0) {
+        void * address = mmap(nullptr, file.length, PROT_READ, MAP_PRIVATE, file.descriptor, 0);
+        if (address == MAP_FAILED) {
+            spdlog::error("Error mapping file to read from: {}", path_to_file);
+            file.close();
+            return 1;
+        }
+        // the whole file is read front to back exactly once
+        madvise(address, file.length, MADV_SEQUENTIAL);
+        file.address = static_cast<std::byte*>(address);
+    }
+    return 0;
+}
+
+int map_for_writing(mapped_file & file, std::string path_to_file, size_t size)
+{
+    file.close();
+    file.descriptor = open(path_to_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file.descriptor == -1 || ftruncate(file.descriptor, size) != 0) {
+        spdlog::error("Error opening file to write to: {}", path_to_file);
+        file.close();
+        return 1;
+    }
+    file.length = size;
+    if (file.length > 0) {
+        void * address = mmap(nullptr, file.length, PROT_READ | PROT_WRITE, MAP_SHARED, file.descriptor, 0);
+        if (address == MAP_FAILED) {
+            spdlog::error("Error mapping file to write to: {}", path_to_file);
+            file.close();
+            return 1;
+        }
+        file.address = static_cast<std::byte*>(address);
+    }
+    return 0;
+}
+
+bool same_file(std::string path_1, std::string path_2)
+{
+    struct stat status_1;
+    struct stat status_2;
+    return stat(path_1.c_str(), &status_1) == 0 && stat(path_2.c_str(), &status_2) == 0
+        && status_1.st_dev == status_2.st_dev && status_1.st_ino == status_2.st_ino;
 }
\ No newline at end of file
@@ -14,18 +14,66 @@ int read_from_binary(
 
 // If the file cannot be opened, then the function will notify the caller
 // by returning 1.
+int write_to_binary(
+    const std::byte * data,
+    size_t size,
+    std::string path_to_file
+);
+
+// class mapped_file
+// -----------------
+// description: A whole file mapped into memory (POSIX mmap), so that its bytes can back a sycl::buffer
+// or be written by the substitution directly, without copies through streams and vectors.
+// The mapping and the file are closed when the object goes out of scope.
+//
+class mapped_file
+{
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file &) = delete;
+    mapped_file & operator=(const mapped_file &) = delete;
+    ~mapped_file();
+
+    std::byte * data() const { return address; }
+    size_t size() const { return length; }
+
+    // writes the mapped bytes back to the file (for mappings opened with map_for_writing)
+    int sync();
+
+private:
+    friend int map_for_reading(mapped_file &, std::string);
+    friend int map_for_writing(mapped_file &, std::string, size_t);
+    void close();
+
+    int descriptor{-1};
+    std::byte * address{nullptr};
+    size_t length{0};
+};
+
+// If the file cannot be opened or mapped, then the functions will notify the caller
+// by returning 1. map_for_writing creates or truncates the file and resizes it to size bytes.
+int map_for_reading(
+    mapped_file & file,
+    std::string path_to_file
+);
+
+int map_for_writing(
+    mapped_file & file,
+    std::string path_to_file,
+    size_t size
+);
+
+// true if both paths name the same existing file (same device and inode), for example through a link;
+// mapping that file for writing would truncate it under a mapping for reading
+bool same_file(
+    std::string path_1,
+    std::string path_2
+);
+
 template <class Writable>
 int write_to_binary(Writable & buffer, std::string path_to_file)
 {
-    std::ofstream output(path_to_file, std::ios::binary);
-    if (!output.is_open()) {
-        spdlog::error("Error opening file to read from: {}", path_to_file);
-        return 1;
-    }
-    // TODO: See if it is possible to write binary data to file without casting.
-    output.write(reinterpret_cast<char*>(&buffer[0]), buffer.size());
-    output.close();
-    return 0;
+    return write_to_binary(reinterpret_cast<const std::byte*>(&buffer[0]), buffer.size(), path_to_file);
 }
 
 #endif
\ No newline at end of file
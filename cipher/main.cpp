@@ -1,6 +1,11 @@
 #include <sycl/sycl.hpp>
 #include <dpc_common.hpp>
 
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <optional>
+
 #include <CLI/CLI.hpp>
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
@@ -10,6 +15,9 @@
 #include "timestamps.h"
 #include "file_ops.h"
 #include "substitute.h"
+#include "substitute_simd.h"
+#include "stream.h"
+#include "batch.h"
 #include "plf_nanotimer.h"
 
 //
@@ -36,6 +44,16 @@ void print_output_message(Iterable & output_message)
     fmt::print("\n");
 }
 
+// note: The same for bytes that are not in a container (e.g., a memory-mapped output file).
+void print_output_message(const std::byte * output_message, const size_t size)
+{
+    fmt::print("output_message: ");
+    std::for_each(output_message, output_message + size, [](std::byte b) {
+        fmt::print("{}", static_cast<char>(b));
+    });
+    fmt::print("\n");
+}
+
 int main(const int argc, const char *const argv[])
 {
     // main declarations :: begin
@@ -44,6 +62,7 @@ int main(const int argc, const char *const argv[])
     std::string input_file_path;
     std::string output_file_path;
     std::string key_file_path;
+    std::string batch_file_path;
     std::vector<std::tuple<std::string, double>> timestamps;
     double time_result;
     // main declarations :: end
@@ -55,10 +74,18 @@ int main(const int argc, const char *const argv[])
     uint grain_size{100};
     const double f_double{10};
     bool run_sequentially{false};
+    std::string engine{"scalar"};
+    std::string memory{"buffer"};
     bool run_cpuonly{false};
     bool encode{false};
     bool decode{false};
     bool print_to_console{false};
+    bool use_mmap{false};
+    bool use_stream{false};
+    size_t chunk_size{4 << 20};
+    size_t number_of_chunks{3};
+    size_t period{0};
+    size_t work_group_size{256};
     //main inits :: end
 
     // cli setup and parse begin
@@ -75,22 +102,191 @@ int main(const int argc, const char *const argv[])
     app.add_option("-o, --outputfile", output_file_path)
         ->check(CLI::ExistingFile);
     app.add_flag("-s, --sequential", run_sequentially);
+    app.add_option("--engine", engine, "substitution engine: scalar (one lookup per byte) or simd (whole vectors)")
+        ->check(CLI::IsMember(std::vector<std::string>{"scalar", "simd"}));
+    app.add_option("--memory", memory, "device memory of the parallel path: buffer (buffers and accessors), usm-shared or usm-device (USM with explicit copies)")
+        ->check(CLI::IsMember(std::vector<std::string>{"buffer", "usm-shared", "usm-device"}));
     app.add_flag("-c, --cpu-only", run_cpuonly);
+    app.add_option("--work-group-size", work_group_size, "work items per work-group of the parallel kernel (at most the device maximum)")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
     app.add_flag("-e, --encode", encode);
     app.add_flag("-d, --decode", decode);
     app.add_flag("-p, --print", print_to_console);
+    app.add_flag("--mmap", use_mmap, "memory-map the input and output files instead of copying them through streams");
+    app.add_flag("--stream", use_stream, "pipeline fixed-size chunks from the input file (or stdin) to the output file (or stdout)");
+    app.add_option("--chunk-size", chunk_size, "bytes per chunk in stream mode")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("--chunks", number_of_chunks, "chunks in flight in stream mode (2: double, 3: triple buffering)")
+        ->check(CLI::Range(2, 64));
+    app.add_option("--polyalphabetic", period, "number of byte maps applied cyclically by byte position (0: one byte map)");
+    app.add_option("-b, --batch", batch_file_path, "manifest with one job per line: encode|decode <input file> <output file> <key file>")
+        ->check(CLI::ExistingFile);
     CLI11_PARSE(app, argc, argv);
     // cli setup and parse end
 
-    // must encode or decode
-    if (encode == decode) {
+    // must encode or decode (in batch mode each job says which)
+    if (batch_file_path.empty() && encode == decode) {
         spdlog::error("must specify -e --encode || -d --decode");
         return 1;
     }
     
+    // polyalphabetic mode needs the position of each byte in the message
+    if (period > 0 && batch_file_path.empty() && (use_stream || engine == "simd")) {
+        spdlog::error("--polyalphabetic does not support --stream or --engine simd");
+        return 1;
+    }
+    
+    // USM applies to the parallel path with one byte map
+    if (memory != "buffer" && (run_sequentially || use_stream || batch_file_path.size() || engine == "simd" || period > 0)) {
+        spdlog::error("--memory {} supports only the parallel path with --engine scalar and one byte map", memory);
+        return 1;
+    }
+    
+    // stream mode :: begin
+    // note: When the output message goes to stdout, the log and the timestamps go to stderr.
+    const bool stream_to_stdout = use_stream && output_file_path.empty();
+    if (stream_to_stdout) {
+        spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+    }
+    if (use_stream && (use_mmap || print_to_console)) {
+        spdlog::warn("--mmap and --print do not apply to stream mode");
+    }
+    // stream mode :: end
+    
+    // note: The output file must not be mapped over the mapped input file: truncating it would pull the input
+    // out from under its mapping, so that case reads and writes through buffers like the default path.
+    if (use_mmap && !use_stream && input_file_path.size() && output_file_path.size() && same_file(input_file_path, output_file_path)) {
+        spdlog::warn("the input and output files are the same, --mmap does not apply");
+        use_mmap = false;
+    }
+    
     plf::nanotimer time_total;
     time_total.start();
     
+    // run batch begin
+    // note: All jobs of the manifest share one queue and one kernel, which amortizes the device setup
+    // across many small files: the messages are concatenated, and each work item looks up the job of its
+    // bytes to select that job's map in the packed byte map table.
+    if (batch_file_path.size()) {
+        if (encode || decode || key_file_path.size() || input_file_path.size() || output_file_path.size() || use_mmap || use_stream || print_to_console || period > 0) {
+            spdlog::warn("the manifest specifies the jobs in batch mode; -e, -d, -f, -i, -o, --mmap, --stream, --print and --polyalphabetic do not apply");
+        }
+        
+        // read manifest :: begin
+        spdlog::info("reading manifest: {}", batch_file_path);
+        plf::nanotimer time_manifest;
+        time_manifest.start();
+        std::vector<batch_job> jobs;
+        if (read_manifest(jobs, batch_file_path) == 1) { return 1; }
+        time_result = time_manifest.get_elapsed_ns();
+        mark_time(timestamps, time_result, "reading manifest");
+        // read manifest :: end
+        
+        // pack keys and messages :: begin
+        plf::nanotimer time_pack;
+        time_pack.start();
+        batch packed;
+        if (pack_batch(jobs, packed) == 1) { return 1; }
+        const auto number_of_jobs = jobs.size();
+        const auto number_of_maps = packed.byte_maps.size() / 256;
+        const auto messages_size = packed.messages.size();
+        const auto batch_work_load{messages_size / grain_size};
+        std::vector<std::byte> output_messages(messages_size);
+        time_result = time_pack.get_elapsed_ns();
+        mark_time(timestamps, time_result, "packing byte maps and input messages");
+        spdlog::info("{} job(s) with {} byte map(s) and {} bytes in total", number_of_jobs, number_of_maps, messages_size);
+        // pack keys and messages :: end
+        
+        if (messages_size == 0) {
+            spdlog::warn("the batch contains no bytes to substitute");
+        }
+        else if (run_sequentially) {
+            // sequential batch substitution :: begin
+            plf::nanotimer time_seq_byte_sub;
+            time_seq_byte_sub.start();
+            if (engine == "simd") {
+                device_name = "sequential " + simd_instruction_set();
+                std::vector<std::byte> byte_map(256);
+                for (size_t j = 0; j < number_of_jobs; j++) {
+                    const auto map = packed.byte_maps.begin() + 256 * packed.job_map[j];
+                    std::copy(map, map + 256, byte_map.begin());
+                    substitute_simd(byte_map, packed.messages.data() + packed.job_begin[j], output_messages.data() + packed.job_begin[j], packed.job_begin[j + 1] - packed.job_begin[j]);
+                }
+            }
+            else {
+                device_name = "sequential";
+                for (size_t i = 0; i < batch_work_load + 1; i++) {
+                    substitute_batch(packed.byte_maps, packed.job_map, packed.job_begin, number_of_jobs, packed.messages, output_messages, messages_size, grain_size, i);
+                }
+            }
+            time_result = time_seq_byte_sub.get_elapsed_ns();
+            mark_time(timestamps, time_result, "sequential batch substitution");
+            // sequential batch substitution :: end
+        }
+        else {
+            // sycl Q creation :: begin
+            plf::nanotimer time_sycl_queue_create;
+            time_sycl_queue_create.start();
+            sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+            sycl::queue Q{device, dpc_common::exception_handler, sycl::property::queue::enable_profiling{}};
+            time_result = time_sycl_queue_create.get_elapsed_ns();
+            mark_time(timestamps, time_result, "queue creation");
+            // sycl Q creation :: end
+            
+            device_name = Q.get_device().get_info<sycl::info::device::name>();
+            spdlog::info("Device: {}", device_name);
+            if (engine == "simd") {
+                spdlog::info("batch mode uses the scalar kernel on devices");
+            }
+            
+            // parallel batch substitution :: begin
+            // note: The output buffer writes the output messages back to the host vector at the end of the scope.
+            plf::nanotimer time_parallel_byte_sub;
+            time_parallel_byte_sub.start();
+            sycl::event substitution;
+            {
+                sycl::buffer<std::byte> byte_maps_buf{packed.byte_maps.data(), sycl::range<1>{packed.byte_maps.size()}};
+                sycl::buffer<uint32_t> job_map_buf{packed.job_map.data(), sycl::range<1>{number_of_jobs}};
+                sycl::buffer<size_t> job_begin_buf{packed.job_begin.data(), sycl::range<1>{number_of_jobs + 1}};
+                sycl::buffer<std::byte> input_messages_buf{packed.messages.data(), sycl::range<1>{messages_size}};
+                sycl::buffer<std::byte> output_messages_buf{output_messages.data(), sycl::range<1>{messages_size}};
+                substitution = Q.submit([&](auto & h) {
+                    const sycl::accessor byte_maps_acc{byte_maps_buf, h, sycl::read_only};
+                    const sycl::accessor job_map_acc{job_map_buf, h, sycl::read_only};
+                    const sycl::accessor job_begin_acc{job_begin_buf, h, sycl::read_only};
+                    const sycl::accessor input_messages_acc{input_messages_buf, h, sycl::read_only};
+                    const sycl::accessor output_messages_acc{output_messages_buf, h, sycl::write_only, sycl::no_init};
+                    
+                    // kernel code
+                    h.parallel_for(batch_work_load + 1, [=](const auto & i) {
+                        substitute_batch(byte_maps_acc, job_map_acc, job_begin_acc, number_of_jobs, input_messages_acc, output_messages_acc, messages_size, grain_size, i);
+                    });
+                });
+            }
+            time_result = time_parallel_byte_sub.get_elapsed_ns();
+            mark_time(timestamps, time_result, "parallel batch substitution");
+            mark_event_times(timestamps, {substitution}, "parallel batch substitution");
+            // parallel batch substitution :: end
+        }
+        
+        // write output messages to output files :: begin
+        spdlog::info("writing {} output file(s)", number_of_jobs);
+        plf::nanotimer time_output;
+        time_output.start();
+        if (write_batch(jobs, packed, output_messages.data()) == 1) { return 1; }
+        time_result = time_output.get_elapsed_ns();
+        mark_time(timestamps, time_result, "write to output files");
+        // write output messages to output files :: end
+        
+        time_result = time_total.get_elapsed_ns();
+        mark_time(timestamps, time_result, "total time");
+        
+        spdlog::info("all done for now");
+        print_timestamps(timestamps);
+        return 0;
+    }
+    // run batch end
+    
     // read key from file :: begin
     if (key_file_path.size()) {
         spdlog::info("reading key from key file: {}", key_file_path);
@@ -103,7 +299,18 @@ int main(const int argc, const char *const argv[])
     // read key from file end :: end
     
     // read input message from file :: begin
-    if (input_file_path.size()) {
+    // note: With --mmap the input message stays in the mapped file, and input_data points into the mapping.
+    mapped_file input_map;
+    const bool input_mapped = use_mmap && input_file_path.size() && !use_stream;
+    if (input_mapped) {
+        spdlog::info("mapping input message from input file: {}", input_file_path);
+        plf::nanotimer time_input_map;
+        time_input_map.start();
+        if (map_for_reading(input_map, input_file_path) == 1) { return 1; }
+        time_result = time_input_map.get_elapsed_ns();
+        mark_time(timestamps, time_result, "mapping input file");
+    }
+    else if (input_file_path.size() && !use_stream) {
         spdlog::info("reading input message from input file: {}", input_file_path);
         plf::nanotimer time_input_vector;
         time_input_vector.start();
@@ -116,7 +323,8 @@ int main(const int argc, const char *const argv[])
     // main domain setup :: begin
     plf::nanotimer time_domain;
     time_domain.start();
-    const auto input_message_size = input_message.size();
+    const std::byte * const input_data = input_mapped ? input_map.data() : input_message.data();
+    const auto input_message_size = input_mapped ? input_map.size() : input_message.size();
     const auto output_message_size = input_message_size;
     const auto work_load{input_message_size / grain_size};
     constexpr auto decimal_begin{0};
@@ -126,7 +334,21 @@ int main(const int argc, const char *const argv[])
     mark_time(timestamps, time_result, "domain setup");
     // main domain setup :: end
     
-    if (input_message_size % grain_size != 0) {
+    // map output file :: begin
+    // note: With --mmap the output file is resized up front, and the output message is written into the mapping.
+    mapped_file output_map;
+    const bool output_mapped = use_mmap && output_file_path.size() && !use_stream;
+    if (output_mapped) {
+        spdlog::info("mapping output file: {}", output_file_path);
+        plf::nanotimer time_output_map;
+        time_output_map.start();
+        if (map_for_writing(output_map, output_file_path, output_message_size) == 1) { return 1; }
+        time_result = time_output_map.get_elapsed_ns();
+        mark_time(timestamps, time_result, "mapping output file");
+    }
+    // map output file :: end
+    
+    if (!use_stream && input_message_size % grain_size != 0) {
         spdlog::warn("input_message_size {} is not a multiple of grain_size {}", input_message_size, grain_size);
     }
     
@@ -134,7 +356,11 @@ int main(const int argc, const char *const argv[])
     spdlog::info("preparing byte map");
     plf::nanotimer time_byte_map_vector;
     time_byte_map_vector.start();
-    if (encode) {
+    if (period > 0) {
+        // note: period x 256 bytes, byte j of the message is substituted by map j % period.
+        byte_map = encode ? scramble_polyalphabetic(key, period) : unscramble_polyalphabetic(key, period);
+    }
+    else if (encode) {
         byte_map = scramble(key, decimal_begin, decimal_end);
     }
     else {
@@ -144,8 +370,92 @@ int main(const int argc, const char *const argv[])
     mark_time(timestamps, time_result, "initializing byte map vector");
     // initializing byte map :: end
     
+    // run streaming begin
+    if (use_stream) {
+        plf::nanotimer time_stream;
+        time_stream.start();
+        
+        // open input and output streams :: begin
+        std::FILE * input = input_file_path.size() ? std::fopen(input_file_path.c_str(), "rb") : stdin;
+        if (input == nullptr) {
+            spdlog::error("Error opening file to read from: {}", input_file_path);
+            return 1;
+        }
+        std::FILE * output = output_file_path.size() ? std::fopen(output_file_path.c_str(), "wb") : stdout;
+        if (output == nullptr) {
+            spdlog::error("Error opening file to write to: {}", output_file_path);
+            return 1;
+        }
+        // open input and output streams :: end
+        
+        // substitution stage :: begin
+        // note: Each chunk is transformed in place, sequentially or by one kernel on the device.
+        std::function<void(std::byte *, size_t)> transform;
+        std::optional<sycl::queue> Q;
+        std::optional<sycl::buffer<std::byte>> byte_map_buf;
+        if (run_sequentially && engine == "simd") {
+            device_name = "sequential " + simd_instruction_set();
+            transform = [&](std::byte * data, const size_t size) {
+                substitute_simd(byte_map, data, data, size);
+            };
+        }
+        else if (run_sequentially) {
+            device_name = "sequential";
+            transform = [&](std::byte * data, const size_t size) {
+                for (size_t i = 0; i < size / grain_size + 1; i++) {
+                    substitute<decltype(byte_map)>(byte_map, data, data, size, grain_size, i);
+                }
+            };
+        }
+        else {
+            plf::nanotimer time_sycl_queue_create;
+            time_sycl_queue_create.start();
+            sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+            Q.emplace(device, dpc_common::exception_handler);
+            byte_map_buf.emplace(byte_map.data(), sycl::range<1>{decimal_end - decimal_begin});
+            time_result = time_sycl_queue_create.get_elapsed_ns();
+            mark_time(timestamps, time_result, "queue creation");
+            device_name = Q->get_device().get_info<sycl::info::device::name>();
+            spdlog::info("Device: {}", device_name);
+            if (engine == "simd") {
+                spdlog::info("stream mode uses the scalar kernel on devices");
+            }
+            transform = [&](std::byte * data, const size_t size) {
+                sycl::buffer<std::byte> chunk_buf{data, sycl::range<1>{size}, {sycl::property::buffer::use_host_ptr{}}};
+                Q->submit([&](auto & h) {
+                    const sycl::accessor byte_map_acc{*byte_map_buf, h, sycl::read_only};
+                    const sycl::accessor chunk_acc{chunk_buf, h};
+                    h.parallel_for(size / grain_size + 1, [=](const auto & i) {
+                        substitute<decltype(byte_map_acc)>(byte_map_acc, chunk_acc, chunk_acc, size, grain_size, i);
+                    });
+                });
+                // end of scope waits for the kernel and leaves the result in the chunk
+            };
+        }
+        // substitution stage :: end
+        
+        spdlog::info("streaming in chunks of {} bytes with {} chunks in flight", chunk_size, number_of_chunks);
+        stream_stats stats;
+        const auto status = stream_cipher(input, output, chunk_size, number_of_chunks, transform, stats);
+        if (input != stdin) { std::fclose(input); }
+        if (output != stdout) { std::fclose(output); }
+        if (status == 1) { return 1; }
+        spdlog::info("streamed {} bytes in {} chunk(s)", stats.bytes, stats.chunks);
+        
+        // busy times of the stages, which overlap within the streaming pipeline row
+        time_result = stats.read_ns;
+        mark_time(timestamps, time_result, "stream read (busy)");
+        time_result = stats.transform_ns;
+        mark_time(timestamps, time_result, "stream substitution (busy)");
+        time_result = stats.write_ns;
+        mark_time(timestamps, time_result, "stream write (busy)");
+        time_result = time_stream.get_elapsed_ns();
+        mark_time(timestamps, time_result, "streaming pipeline");
+    }
+    // run streaming end
+    
     // run sequential begin
-    if (run_sequentially) {
+    else if (run_sequentially) {
         plf::nanotimer time_sequential;
         time_sequential.start();
         device_name = "sequential";
@@ -154,20 +464,33 @@ int main(const int argc, const char *const argv[])
         spdlog::info("allocating memory for output message sequential");
         plf::nanotimer time_output_alloc;
         time_output_alloc.start();
-        std::vector<std::byte> output_message(output_message_size);
+        std::vector<std::byte> output_message(output_mapped ? 0 : output_message_size);
+        std::byte * const output_data = output_mapped ? output_map.data() : output_message.data();
         time_result = time_output_alloc.get_elapsed_ns();
         mark_time(timestamps, time_result, "output message vector memmory alloc");
         // memory allocation for output message :: end
         
         // sequential byte substitution :: begin
-        spdlog::info("starting sequential byte substitution");
+        spdlog::info("starting sequential byte substitution ({})", engine);
         plf::nanotimer time_seq_byte_sub;
         time_seq_byte_sub.start();
-        for (int i = 0; i < work_load + 1; i++) {
-            substitute<decltype(byte_map)>(byte_map, input_message, output_message, input_message_size, grain_size, i);
+        if (engine == "simd") {
+            device_name = "sequential " + simd_instruction_set();
+            substitute_simd(byte_map, input_data, output_data, input_message_size);
+        }
+        else if (period > 0) {
+            for (size_t i = 0; i < work_load + 1; i++) {
+                substitute_periodic(byte_map, period, input_data, output_data, input_message_size, grain_size, i);
+            }
+        }
+        else {
+            for (int i = 0; i < work_load + 1; i++) {
+                substitute<decltype(byte_map)>(byte_map, input_data, output_data, input_message_size, grain_size, i);
+            }
         }
         time_result = time_seq_byte_sub.get_elapsed_ns();
         mark_time(timestamps, time_result, "sequential byte substitution");
+        mark_bandwidth(timestamps, 2.0 * input_message_size, time_result, "sequential byte substitution");
         // sequential byte substitution :: end
         
         // write output message to output file :: begin
@@ -175,7 +498,10 @@ int main(const int argc, const char *const argv[])
             spdlog::info("preparing to write new msg to: {}", output_file_path);
             plf::nanotimer time_seq_output;
             time_seq_output.start();
-            if (write_to_binary<std::vector<std::byte>>(output_message, output_file_path) == 1) { return 1; }
+            if (output_mapped) {
+                if (output_map.sync() == 1) { return 1; }
+            }
+            else if (write_to_binary<std::vector<std::byte>>(output_message, output_file_path) == 1) { return 1; }
             time_result = time_seq_output.get_elapsed_ns();
             mark_time(timestamps, time_result, "write to output file");
         }
@@ -186,7 +512,7 @@ int main(const int argc, const char *const argv[])
             spdlog::info("preparing to print output_message to console");
             plf::nanotimer time_seq_print;
             time_seq_print.start();
-            print_output_message<std::vector<std::byte>>(output_message);
+            print_output_message(output_data, output_message_size);
             time_result = time_seq_print.get_elapsed_ns();
             mark_time(timestamps, time_result, "print to console");
         }
@@ -198,19 +524,27 @@ int main(const int argc, const char *const argv[])
     }
     // run sequential end
     
-    // run parallel begin
-    else {
+    // run parallel simd begin
+    else if (engine == "simd") {
         plf::nanotimer time_parallel;
         time_parallel.start();
         
         // allocate sycl buffer memory :: begin
+        // note: The message is padded with zero bytes to whole 16-byte words, so that the kernel
+        // can load and store them as vectors; only the first input_message_size bytes are output.
         spdlog::info("allocating memory for sycl buffers");
         plf::nanotimer time_sycl_buf_alloc;
         time_sycl_buf_alloc.start();
+        const auto number_of_words = (input_message_size + 15) / 16;
+        const auto word_work_load{number_of_words / grain_size};
+        if (input_mapped) {
+            // the padding does not fit into the mapping, so the simd engine copies a mapped input message
+            input_message.assign(input_data, input_data + input_message_size);
+        }
+        input_message.resize(16 * number_of_words);
         sycl::buffer<std::byte> byte_map_buf{byte_map.data(), sycl::range<1>{decimal_end - decimal_begin}};
-        sycl::buffer<std::byte> input_message_buf{input_message.data(), sycl::range<1>{input_message_size}};
-        sycl::buffer<std::byte> output_message_buf{sycl::range<1>{output_message_size}};
-        sycl::buffer<std::byte> flag_buf{sycl::range<1>{1}};
+        sycl::buffer<sycl::uchar16> input_words_buf{reinterpret_cast<sycl::uchar16*>(input_message.data()), sycl::range<1>{number_of_words}};
+        sycl::buffer<sycl::uchar16> output_words_buf{sycl::range<1>{number_of_words}};
         time_result = time_sycl_buf_alloc.get_elapsed_ns();
         mark_time(timestamps, time_result, "sycl buffer memmory alloc");
         // allocate sycl buffer memory :: end
@@ -219,7 +553,7 @@ int main(const int argc, const char *const argv[])
         plf::nanotimer time_sycl_queue_create;
         time_sycl_queue_create.start();
         sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
-        sycl::queue Q{device, dpc_common::exception_handler};
+        sycl::queue Q{device, dpc_common::exception_handler, sycl::property::queue::enable_profiling{}};
         time_result = time_sycl_queue_create.get_elapsed_ns();
         mark_time(timestamps, time_result, "queue creation");
         // sycl Q creation :: end
@@ -227,30 +561,279 @@ int main(const int argc, const char *const argv[])
         device_name = Q.get_device().get_info<sycl::info::device::name>();
         spdlog::info("Device: {}", device_name);
         
-        // populate output message buffer with new msg
-        spdlog::info("preparing for parallel byte substitutions");
-        Q.submit([&](auto & h) {
+        // populate output words buffer with new msg
+        spdlog::info("preparing for parallel word substitutions");
+        plf::nanotimer time_submit;
+        time_submit.start();
+        auto substitution = Q.submit([&](auto & h) {
             // data transfer ocurring here
             const sycl::accessor byte_map_acc{byte_map_buf, h};
-            const sycl::accessor input_message_acc{input_message_buf, h};
-            const sycl::accessor output_message_acc{output_message_buf, h};
-            const sycl::accessor flag_acc{flag_buf, h};
+            const sycl::accessor input_words_acc{input_words_buf, h};
+            const sycl::accessor output_words_acc{output_words_buf, h};
             
             // kernel code
-            h.parallel_for(work_load + 1, [=](const auto & i) {
-                substitute<decltype(byte_map_acc)>(byte_map_acc, input_message_acc, output_message_acc, input_message_size, grain_size, i);
+            h.parallel_for(word_work_load + 1, [=](const auto & i) {
+                substitute_words(byte_map_acc, input_words_acc, output_words_acc, number_of_words, grain_size, i);
             });
         });
+        time_result = time_submit.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel word substitution submit");
+        spdlog::info("done submitting to queue...waiting for results");
+        
+        // wait for the kernel on target device :: begin
+        plf::nanotimer time_parallel_byte_sub;
+        time_parallel_byte_sub.start();
+        substitution.wait();
+        time_result = time_parallel_byte_sub.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel word substitution host wait");
+        time_result = mark_event_times(timestamps, {substitution}, "parallel word substitution");
+        mark_bandwidth(timestamps, 2.0 * input_message_size, time_result, "parallel word substitution");
+        // wait for the kernel on target device :: end
+    
+        // host accessor to synchronize memory :: begin
+        spdlog::info("preparing output_message access");
+        plf::nanotimer time_host_access;
+        time_host_access.start();
+        const sycl::host_accessor output_words{output_words_buf};
+        const auto output_message = reinterpret_cast<const std::byte*>(&output_words[0]);
+        time_result = time_host_access.get_elapsed_ns();
+        mark_time(timestamps, time_result, "host data access");
+        // host accessor to synchronize memory :: end
+        
+        // write output message to output file :: begin
+        if (output_file_path.size()) {
+            spdlog::info("preparing to write new msg to: {}", output_file_path);
+            plf::nanotimer time_output;
+            time_output.start();
+            
+            if (output_mapped) {
+                std::copy(output_message, output_message + output_message_size, output_map.data());
+                if (output_map.sync() == 1) { return 1; }
+            }
+            else if (write_to_binary(output_message, output_message_size, output_file_path) == 1) { return 1; }
+            
+            time_result = time_output.get_elapsed_ns();
+            mark_time(timestamps, time_result, "write to output file");
+        }
+        // write output message to output file :: end
+        
+        // print output message to console :: begin
+        if (print_to_console) {
+            spdlog::info("preparing to write output_message to console");
+            plf::nanotimer time_print;
+            time_print.start();
+            
+            print_output_message(output_message, output_message_size);
+            
+            time_result = time_print.get_elapsed_ns();
+            mark_time(timestamps, time_result, "print to console");
+        }
+        // print output message to console :: end
+        
+        time_result = time_parallel.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel block");
+    }
+    // run parallel simd end
+    
+    // run parallel usm begin
+    // note: Instead of buffers and accessors, the message is copied to the device with explicit memcpy
+    // events (usm-device), or it is placed in shared allocations that migrate on demand (usm-shared).
+    else if (memory != "buffer") {
+        plf::nanotimer time_parallel;
+        time_parallel.start();
+        const bool shared = memory == "usm-shared";
+        
+        // sycl Q creation :: begin
+        plf::nanotimer time_sycl_queue_create;
+        time_sycl_queue_create.start();
+        sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+        sycl::queue Q{device, dpc_common::exception_handler, sycl::property::queue::enable_profiling{}};
+        time_result = time_sycl_queue_create.get_elapsed_ns();
+        mark_time(timestamps, time_result, "queue creation");
+        // sycl Q creation :: end
+        
+        device_name = Q.get_device().get_info<sycl::info::device::name>();
+        spdlog::info("Device: {}", device_name);
+        const auto max_work_group_size = Q.get_device().get_info<sycl::info::device::max_work_group_size>();
+        if (work_group_size > max_work_group_size) {
+            spdlog::warn("work_group_size {} exceeds the device maximum {}", work_group_size, max_work_group_size);
+            work_group_size = max_work_group_size;
+        }
+        
+        // allocate usm memory :: begin
+        // note: The output message comes back into pinned host memory (or straight into the mapped output file),
+        // so that it is written to the output file without another copy; shared allocations are used in place.
+        spdlog::info("allocating {} memory", memory);
+        plf::nanotimer time_usm_alloc;
+        time_usm_alloc.start();
+        auto usm_free = [&Q](std::byte * p) { sycl::free(p, Q); };
+        using usm_ptr = std::unique_ptr<std::byte, decltype(usm_free)>;
+        const auto usm_alloc = [&](const size_t size) {
+            return usm_ptr{shared ? sycl::malloc_shared<std::byte>(size, Q) : sycl::malloc_device<std::byte>(size, Q), usm_free};
+        };
+        const usm_ptr byte_map_usm = usm_alloc(byte_map.size());
+        const usm_ptr input_message_usm = usm_alloc(input_message_size);
+        const usm_ptr output_message_usm = usm_alloc(output_message_size);
+        const usm_ptr output_message_host{shared || output_mapped ? nullptr : sycl::malloc_host<std::byte>(output_message_size, Q), usm_free};
+        if (!byte_map_usm || (input_message_size > 0 && (!input_message_usm || !output_message_usm || (!shared && !output_mapped && !output_message_host)))) {
+            spdlog::error("Error allocating {} bytes of {} memory", byte_map.size() + input_message_size + output_message_size, memory);
+            return 1;
+        }
+        std::byte * const output_message = shared ? output_message_usm.get() : output_mapped ? output_map.data() : output_message_host.get();
+        time_result = time_usm_alloc.get_elapsed_ns();
+        mark_time(timestamps, time_result, "usm memory alloc");
+        // allocate usm memory :: end
+        
+        // host to device :: begin
+        spdlog::info("copying byte map and input message to the device");
+        plf::nanotimer time_h2d;
+        time_h2d.start();
+        std::vector<sycl::event> h2d{
+            Q.memcpy(byte_map_usm.get(), byte_map.data(), byte_map.size()),
+            Q.memcpy(input_message_usm.get(), input_data, input_message_size)
+        };
+        sycl::event::wait(h2d);
+        time_result = time_h2d.get_elapsed_ns();
+        mark_time(timestamps, time_result, "H2D host wait");
+        mark_event_times(timestamps, h2d, "H2D");
+        // host to device :: end
+        
+        // parallel byte substitution :: begin
+        spdlog::info("preparing for parallel byte substitutions");
+        plf::nanotimer time_submit;
+        time_submit.start();
+        auto substitution = submit_substitute_tiles(Q, byte_map_usm.get(), input_message_usm.get(), output_message_usm.get(), input_message_size, grain_size, work_group_size, h2d);
+        time_result = time_submit.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel byte substitution submit");
+        plf::nanotimer time_parallel_byte_sub;
+        time_parallel_byte_sub.start();
+        substitution.wait();
+        time_result = time_parallel_byte_sub.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel byte substitution host wait");
+        time_result = mark_event_times(timestamps, {substitution}, "parallel byte substitution");
+        mark_bandwidth(timestamps, 2.0 * input_message_size, time_result, "parallel byte substitution");
+        // parallel byte substitution :: end
+        
+        // device to host :: begin
+        // note: Shared allocations need no copy; their pages migrate when the output message is written.
+        if (!shared) {
+            plf::nanotimer time_d2h;
+            time_d2h.start();
+            auto d2h = Q.memcpy(output_message, output_message_usm.get(), output_message_size);
+            d2h.wait();
+            time_result = time_d2h.get_elapsed_ns();
+            mark_time(timestamps, time_result, "D2H host wait");
+            mark_event_times(timestamps, {d2h}, "D2H");
+        }
+        // device to host :: end
+        
+        // write output message to output file :: begin
+        if (output_file_path.size()) {
+            spdlog::info("preparing to write new msg to: {}", output_file_path);
+            plf::nanotimer time_output;
+            time_output.start();
+            
+            if (output_mapped) {
+                if (shared) {
+                    std::copy(output_message, output_message + output_message_size, output_map.data());
+                }
+                if (output_map.sync() == 1) { return 1; }
+            }
+            else if (write_to_binary(output_message, output_message_size, output_file_path) == 1) { return 1; }
+            
+            time_result = time_output.get_elapsed_ns();
+            mark_time(timestamps, time_result, "write to output file");
+        }
+        // write output message to output file :: end
+        
+        // print output message to console :: begin
+        if (print_to_console) {
+            spdlog::info("preparing to write output_message to console");
+            plf::nanotimer time_print;
+            time_print.start();
+            
+            print_output_message(output_message, output_message_size);
+            
+            time_result = time_print.get_elapsed_ns();
+            mark_time(timestamps, time_result, "print to console");
+        }
+        // print output message to console :: end
+        
+        time_result = time_parallel.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel block");
+    }
+    // run parallel usm end
+    
+    // run parallel begin
+    else {
+        plf::nanotimer time_parallel;
+        time_parallel.start();
+        
+        // allocate sycl buffer memory :: begin
+        spdlog::info("allocating memory for sycl buffers");
+        plf::nanotimer time_sycl_buf_alloc;
+        time_sycl_buf_alloc.start();
+        sycl::buffer<std::byte> byte_map_buf{byte_map.data(), sycl::range<1>{byte_map.size()}};
+        // note: use_host_ptr lets the runtime work on the (mapped) host memory instead of its own copy,
+        // and the const input pointer means that the input message is never written back.
+        sycl::buffer<std::byte> input_message_buf{input_data, sycl::range<1>{input_message_size}, {sycl::property::buffer::use_host_ptr{}}};
+        sycl::buffer<std::byte> output_message_buf = output_mapped
+            ? sycl::buffer<std::byte>{output_map.data(), sycl::range<1>{output_message_size}, {sycl::property::buffer::use_host_ptr{}}}
+            : sycl::buffer<std::byte>{sycl::range<1>{output_message_size}};
+        time_result = time_sycl_buf_alloc.get_elapsed_ns();
+        mark_time(timestamps, time_result, "sycl buffer memmory alloc");
+        // allocate sycl buffer memory :: end
+        
+        // sycl Q creation :: begin
+        plf::nanotimer time_sycl_queue_create;
+        time_sycl_queue_create.start();
+        sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+        sycl::queue Q{device, dpc_common::exception_handler, sycl::property::queue::enable_profiling{}};
+        time_result = time_sycl_queue_create.get_elapsed_ns();
+        mark_time(timestamps, time_result, "queue creation");
+        // sycl Q creation :: end
+        
+        device_name = Q.get_device().get_info<sycl::info::device::name>();
+        spdlog::info("Device: {}", device_name);
+        
+        // populate output message buffer with new msg
+        spdlog::info("preparing for parallel byte substitutions");
+        const auto max_work_group_size = Q.get_device().get_info<sycl::info::device::max_work_group_size>();
+        if (work_group_size > max_work_group_size) {
+            spdlog::warn("work_group_size {} exceeds the device maximum {}", work_group_size, max_work_group_size);
+            work_group_size = max_work_group_size;
+        }
+        plf::nanotimer time_submit;
+        time_submit.start();
+        sycl::event substitution;
+        if (period > 0) {
+            // note: The byte maps are staged in local memory when they fit, else they are read from global memory.
+            const bool stage_in_local_memory = byte_map.size() <= Q.get_device().get_info<sycl::info::device::local_mem_size>();
+            spdlog::info("{} byte maps in {} memory", period, stage_in_local_memory ? "local" : "global");
+            substitution = submit_substitute_periodic(Q, byte_map_buf, period, input_message_buf, output_message_buf, input_message_size, grain_size, work_group_size, stage_in_local_memory);
+        }
+        else {
+            // note: Each work-group stages the byte map in local memory and substitutes a tile of
+            // work_group_size * grain_size bytes, with neighbouring work items on neighbouring bytes.
+            spdlog::info("tiles of {} bytes in work-groups of {}", work_group_size * grain_size, work_group_size);
+            substitution = submit_substitute_tiles(Q, byte_map_buf, input_message_buf, output_message_buf, input_message_size, grain_size, work_group_size);
+        }
+        time_result = time_submit.get_elapsed_ns();
+        mark_time(timestamps, time_result, "parallel byte substitution submit");
         spdlog::info("done submitting to queue...waiting for results");
         
-        // access flag buff to initiate work on target device :: begin
-        spdlog::info("preparing flag access");
+        // wait for the kernel on target device :: begin
+        // note: The host wait includes the transfers to the device; the queue wait and execute rows
+        // come from the profiling info of the kernel's event.
         plf::nanotimer time_parallel_byte_sub;
         time_parallel_byte_sub.start();
-        const sycl::host_accessor flag{flag_buf};
+        substitution.wait();
         time_result = time_parallel_byte_sub.get_elapsed_ns();
-        mark_time(timestamps, time_result, "parallel byte substitution");
-        // access flag buff to initiate work on target device :: end
+        mark_time(timestamps, time_result, "parallel byte substitution host wait");
+        time_result = mark_event_times(timestamps, {substitution}, "parallel byte substitution");
+        // note: Bytes read plus bytes written per nanosecond of kernel execution, to compare with the device memory bandwidth.
+        mark_bandwidth(timestamps, 2.0 * input_message_size, time_result, "parallel byte substitution");
+        // wait for the kernel on target device :: end
     
         // host accessor to synchronize memory :: begin
         spdlog::info("preparing output_message access");
@@ -267,7 +850,11 @@ int main(const int argc, const char *const argv[])
             plf::nanotimer time_output;
             time_output.start();
             
-            if (write_to_binary<decltype(output_message)>(output_message, output_file_path) == 1) { return 1; }
+            // the host accessor of the mapped output buffer is the mapping itself
+            if (output_mapped) {
+                if (output_map.sync() == 1) { return 1; }
+            }
+            else if (write_to_binary<decltype(output_message)>(output_message, output_file_path) == 1) { return 1; }
             
             time_result = time_output.get_elapsed_ns();
             mark_time(timestamps, time_result, "write to output file");
@@ -296,6 +883,6 @@ int main(const int argc, const char *const argv[])
     mark_time(timestamps, time_result, "total time");
     
     spdlog::info("all done for now");
-    print_timestamps(timestamps);
+    print_timestamps(timestamps, stream_to_stdout ? stderr : stdout);
     return 0;
 }
\ No newline at end of file
@@ -18,36 +18,11 @@
 // The bytes represented by the indices correspond to plaintext.
 // The bytes represented by the elements correspond to ciphertext.
 //
-std::vector<std::byte> scramble(std::vector<std::byte> key, const int decimal_begin, const int decimal_end)
+std::vector<std::byte> scramble(const std::vector<std::byte> & key, const int decimal_begin, const int decimal_end)
 {
-    // Function call to remove duplicate bytes in the key.
-    remove_duplicates(key);
-    
-    // Declarations
-    std::list<std::byte> byte_list;
-    std::vector<std::byte> byte_map;
-    std::byte byte;
-    
-    // Initializing the key_size for iterating over the key object.
-    const auto key_size = key.size();
-    
-    // Step 1: Initializing the byte_list with bytes ranging from decimal_begin to decimal_end.
-    for (int i = decimal_begin; i < (decimal_end + decimal_begin); i++) {
-        byte_list.push_back(static_cast<std::byte>(i));
-    }
-    
-    // Step 2: Writing the bytes contained in object key to the byte_map and removing key bytes from the byte_list.
-    for (int i = 0; i < key_size; i++) {
-        byte_map.push_back(static_cast<std::byte>(key[i]));
-        byte_list.remove(static_cast<std::byte>(key[i]));
-    }
-    
-    // Step 3: Writing the remaining bytes from the byte_list to the byte_map.
-    for (int i = decimal_begin; i < (decimal_begin + decimal_end - key_size); i++) {
-        byte = byte_list.front();
-        byte_map.push_back(byte);
-        byte_list.pop_front();
-    }
+    // The byte_map is at most as long as the range, unless the key alone is longer.
+    std::vector<std::byte> byte_map(std::max<size_t>(decimal_end, 256));
+    byte_map.resize(scramble_into(key.data(), key.size(), decimal_begin, decimal_end, byte_map.data()));
     // All done.
     return byte_map;
 }
@@ -70,39 +45,56 @@ std::vector<std::byte> scramble(std::vector<std::byte> key, const int decimal_be
 // The bytes represented by the indices correspond to ciphertext.
 // The bytes represented by the elements correspond to plaintext.
 //
-std::vector<std::byte> unscramble(std::vector<std::byte> key, const int decimal_begin, const int decimal_end)
+std::vector<std::byte> unscramble(const std::vector<std::byte> & key, const int decimal_begin, const int decimal_end)
 {
-    // Function call to remove duplicate bytes in the key.
-    remove_duplicates(key);
-    
-    // Declarations
-    std::vector<std::byte> byte_map;
-    std::byte index_byte;
-    std::byte byte;
-    
-    // Initializing counter_not to the size of the object key; this is the starting decimal value for bytes that are NOT mapped to by the key.
-    auto counter_not = key.size();
-    
-    // Populating byte_map
-    for (int i = decimal_begin; i < (decimal_end + decimal_begin); i++) {
-        index_byte = static_cast<std::byte>(i);
-        // Step 1: Find if the current_byte is contained in the object key.
-        auto found = std::find_if(key.begin(), key.end(), [&index_byte](std::byte b) {
-            return b == index_byte;
-        });
-        // Step 2: If the index_byte is not contained in the object key, then map to the byte value of decimal counter_not and increment counter_not.
-        if (found == key.end()) {
-            byte = static_cast<std::byte>(counter_not++);
-            byte_map.push_back(byte);
+    std::vector<std::byte> byte_map(decimal_end);
+    unscramble_into(key.data(), key.size(), decimal_begin, decimal_end, byte_map.data());
+    // All done.
+    return byte_map;
+}
+
+// function scramble_polyalphabetic
+// --------------------------------
+// inputs: A key and the number of byte maps (period).
+//
+// output: Returns period byte maps of 256 bytes each, one after the other, where byte j of a message
+// is substituted by map j % period.
+//
+// description: Map p adds the key byte key[p % key size] to a byte (modulo 256) before substituting
+// it with the scramble byte_map of the key (Vigenere-style), so that equal plaintext bytes at different
+// positions become different ciphertext bytes.
+//
+std::vector<std::byte> scramble_polyalphabetic(const std::vector<std::byte> & key, const size_t period)
+{
+    const auto byte_map = scramble(key, 0, 256);
+    std::vector<std::byte> byte_maps(256 * period);
+    for (size_t p = 0; p < period; p++) {
+        const auto shift = key.empty() ? 0 : std::to_integer<unsigned>(key[p % key.size()]);
+        for (unsigned b = 0; b < 256; b++) {
+            byte_maps[256 * p + b] = byte_map[(b + shift) % 256];
         }
-        // Step 3: Else the index_byte is contained in the object key, then map to the byte value of the index containing the element index_byte.
-        else {
-            byte = static_cast<std::byte>(std::distance(key.begin(), found)); // finding the index of the iterator found
-            byte_map.push_back(byte);
+    }
+    return byte_maps;
+}
+
+// function unscramble_polyalphabetic
+// ----------------------------------
+// inputs: A key and the number of byte maps (period).
+//
+// output: Returns the inverses of the maps of scramble_polyalphabetic: map p unscrambles a byte
+// and then subtracts the key byte key[p % key size] (modulo 256).
+//
+std::vector<std::byte> unscramble_polyalphabetic(const std::vector<std::byte> & key, const size_t period)
+{
+    const auto byte_map = unscramble(key, 0, 256);
+    std::vector<std::byte> byte_maps(256 * period);
+    for (size_t p = 0; p < period; p++) {
+        const auto shift = key.empty() ? 0 : std::to_integer<unsigned>(key[p % key.size()]);
+        for (unsigned c = 0; c < 256; c++) {
+            byte_maps[256 * p + c] = static_cast<std::byte>((std::to_integer<unsigned>(byte_map[c]) + 256 - shift) % 256);
         }
     }
-    // All done.
-    return byte_map;
+    return byte_maps;
 }
 
 // function remove_duplicates
@@ -112,11 +104,11 @@ std::vector<std::byte> unscramble(std::vector<std::byte> key, const int decimal_
 // description: This function removes all duplicate bytes from the provided argument.
 void remove_duplicates(std::vector<std::byte> & key)
 {
-    std::set<std::byte> unique_bytes;
+    byte_set unique_bytes;
     key.erase(
         std::remove_if(
             key.begin(), key.end(), [&unique_bytes] (std::byte b) {
-                if (unique_bytes.count(b) > 0) { return true; }
+                if (unique_bytes.contains(b)) { return true; }
                 unique_bytes.insert(b);
                 return false;
             }
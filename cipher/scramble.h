@@ -2,24 +2,129 @@
 #define SCRAMBLE_H
 
 #include <algorithm>
-#include <list>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <set>
 
-// note: Argument key is passed by value this way the key object in main is unaffected
-// by function calls to remove_duplicates from within scramble and unscramble.
+// struct byte_set
+// ---------------
+// description: A 256-bit mask of the bytes seen so far (constant memory, constant time per byte).
+//
+struct byte_set
+{
+    uint64_t words[4]{};
+
+    constexpr bool contains(const std::byte b) const
+    {
+        const auto i = std::to_integer<unsigned>(b);
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    constexpr void insert(const std::byte b)
+    {
+        const auto i = std::to_integer<unsigned>(b);
+        words[i / 64] |= uint64_t{1} << (i % 64);
+    }
+};
+
+// function scramble_into
+// ----------------------
+// description: Writes the scramble byte_map (see scramble.cpp) into byte_map and returns its size,
+// which is at most max(decimal_end, 256). The duplicates in the key are skipped on the fly,
+// so this takes O(key size + decimal_end) time regardless of the key and needs no allocation.
+//
+constexpr size_t scramble_into(const std::byte * key, const size_t key_size, const int decimal_begin, const int decimal_end, std::byte * byte_map)
+{
+    byte_set in_key;
+    size_t size = 0;
+    // Step 1: Writing the (unique) bytes contained in the key to the byte_map.
+    for (size_t k = 0; k < key_size; k++) {
+        if (!in_key.contains(key[k])) {
+            in_key.insert(key[k]);
+            byte_map[size++] = key[k];
+        }
+    }
+    // Step 2: Writing the remaining bytes of the range that are not in the key.
+    for (int i = decimal_begin; i < (decimal_end + decimal_begin) && size < static_cast<size_t>(decimal_end); i++) {
+        const auto byte = static_cast<std::byte>(i);
+        if (!in_key.contains(byte)) {
+            byte_map[size++] = byte;
+        }
+    }
+    return size;
+}
+
+// function unscramble_into
+// ------------------------
+// description: Writes the unscramble byte_map (see scramble.cpp) into byte_map and returns its size (decimal_end).
+// Instead of searching the key for every byte, the positions of the (unique) key bytes are
+// recorded in a 256-entry table first, which inverts the scramble byte_map in O(key size + decimal_end) time.
+//
+constexpr size_t unscramble_into(const std::byte * key, const size_t key_size, const int decimal_begin, const int decimal_end, std::byte * byte_map)
+{
+    int position[256]{};
+    byte_set in_key;
+    size_t unique = 0;
+    for (size_t k = 0; k < key_size; k++) {
+        if (!in_key.contains(key[k])) {
+            in_key.insert(key[k]);
+            position[std::to_integer<unsigned>(key[k])] = static_cast<int>(unique++);
+        }
+    }
+    auto counter_not = unique;
+    size_t size = 0;
+    for (int i = decimal_begin; i < (decimal_end + decimal_begin); i++) {
+        const auto index_byte = static_cast<std::byte>(i);
+        byte_map[size++] = in_key.contains(index_byte)
+            ? static_cast<std::byte>(position[std::to_integer<unsigned>(index_byte)])
+            : static_cast<std::byte>(counter_not++);
+    }
+    return size;
+}
+
+// byte maps for keys known at compile time (full decimal range 0..256), e.g.
+// constexpr auto byte_map = scramble_array(std::array{std::byte{67}, std::byte{121}});
+template <size_t N>
+constexpr std::array<std::byte, 256> scramble_array(const std::array<std::byte, N> & key)
+{
+    std::array<std::byte, 256> byte_map{};
+    scramble_into(key.data(), N, 0, 256, byte_map.data());
+    return byte_map;
+}
+
+template <size_t N>
+constexpr std::array<std::byte, 256> unscramble_array(const std::array<std::byte, N> & key)
+{
+    std::array<std::byte, 256> byte_map{};
+    unscramble_into(key.data(), N, 0, 256, byte_map.data());
+    return byte_map;
+}
+
+// note: The key is not modified; duplicate bytes in it are skipped while the byte_map is built.
 std::vector<std::byte> scramble(
-    std::vector<std::byte> key,
+    const std::vector<std::byte> & key,
     const int decimal_begin,
     const int decimal_end
 );
 
 std::vector<std::byte> unscramble(
-    std::vector<std::byte> key,
+    const std::vector<std::byte> & key,
     const int decimal_begin,
     const int decimal_end
 );
 
+// note: Polyalphabetic byte maps for the full decimal range (0..256), period x 256 bytes (see scramble.cpp).
+std::vector<std::byte> scramble_polyalphabetic(
+    const std::vector<std::byte> & key,
+    const size_t period
+);
+
+std::vector<std::byte> unscramble_polyalphabetic(
+    const std::vector<std::byte> & key,
+    const size_t period
+);
+
 // note: Argument key is passed by reference here.
 void remove_duplicates(
     std::vector<std::byte> & key
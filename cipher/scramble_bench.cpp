@@ -0,0 +1,134 @@
+#include <list>
+#include <random>
+#include <set>
+
+#include <CLI/CLI.hpp>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "scramble.h"
+#include "file_ops.h"
+#include "timestamps.h"
+#include "plf_nanotimer.h"
+
+// byte map construction: the O(key + 256) builders in scramble.h
+// against the previous list-based versions, which are kept here as the baseline
+
+namespace legacy {
+
+void remove_duplicates(std::vector<std::byte> & key)
+{
+    std::set<std::byte> unique_bytes;
+    key.erase(
+        std::remove_if(
+            key.begin(), key.end(), [&unique_bytes] (std::byte b) {
+                if (unique_bytes.count(b) > 0) { return true; }
+                unique_bytes.insert(b);
+                return false;
+            }
+        ),
+        key.end()
+    );
+}
+
+std::vector<std::byte> scramble(std::vector<std::byte> key, const int decimal_begin, const int decimal_end)
+{
+    remove_duplicates(key);
+    std::list<std::byte> byte_list;
+    std::vector<std::byte> byte_map;
+    const auto key_size = key.size();
+    for (int i = decimal_begin; i < (decimal_end + decimal_begin); i++) {
+        byte_list.push_back(static_cast<std::byte>(i));
+    }
+    for (int i = 0; i < key_size; i++) {
+        byte_map.push_back(static_cast<std::byte>(key[i]));
+        byte_list.remove(static_cast<std::byte>(key[i]));
+    }
+    for (int i = decimal_begin; i < (decimal_begin + decimal_end - key_size); i++) {
+        byte_map.push_back(byte_list.front());
+        byte_list.pop_front();
+    }
+    return byte_map;
+}
+
+std::vector<std::byte> unscramble(std::vector<std::byte> key, const int decimal_begin, const int decimal_end)
+{
+    remove_duplicates(key);
+    std::vector<std::byte> byte_map;
+    auto counter_not = key.size();
+    for (int i = decimal_begin; i < (decimal_end + decimal_begin); i++) {
+        const auto index_byte = static_cast<std::byte>(i);
+        auto found = std::find_if(key.begin(), key.end(), [&index_byte](std::byte b) {
+            return b == index_byte;
+        });
+        if (found == key.end()) {
+            byte_map.push_back(static_cast<std::byte>(counter_not++));
+        }
+        else {
+            byte_map.push_back(static_cast<std::byte>(std::distance(key.begin(), found)));
+        }
+    }
+    return byte_map;
+}
+
+} // namespace legacy
+
+int main(const int argc, const char *const argv[])
+{
+    std::string key_file_path;
+    size_t key_size{1 << 24};
+    uint repetitions{5};
+    std::vector<std::tuple<std::string, double>> timestamps;
+    double time_result;
+
+    CLI::App app{"Byte map construction benchmark"};
+    app.option_defaults()->always_capture_default(true);
+    app.add_option("-f, --keyfile", key_file_path, "key file (instead of a random key)")
+        ->check(CLI::ExistingFile);
+    app.add_option("-n, --key-size", key_size, "size of the random key in bytes")
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("-r, --repetitions", repetitions)
+        ->check(CLI::PositiveNumber.description(" >= 1"));
+    CLI11_PARSE(app, argc, argv);
+
+    // key :: begin
+    std::vector<std::byte> key;
+    if (key_file_path.size()) {
+        if (read_from_binary(key, key_file_path) == 1) { return 1; }
+    }
+    else {
+        std::mt19937 generator{42};
+        key.resize(key_size);
+        for (auto & b : key) { b = static_cast<std::byte>(generator()); }
+    }
+    spdlog::info("building byte maps for a key of {} bytes", key.size());
+    // key :: end
+
+    constexpr auto decimal_begin{0};
+    constexpr auto decimal_end{256};
+    const auto measure = [&](const std::string_view label, const auto & build) {
+        std::vector<std::byte> byte_map;
+        double best = std::numeric_limits<double>::max();
+        for (uint r = 0; r < repetitions; r++) {
+            plf::nanotimer timer;
+            timer.start();
+            byte_map = build(key, decimal_begin, decimal_end);
+            best = std::min(best, timer.get_elapsed_ns());
+        }
+        time_result = best;
+        mark_time(timestamps, time_result, label);
+        return byte_map;
+    };
+
+    const auto scramble_legacy = measure("scramble (list, best)", legacy::scramble);
+    const auto scramble_mask = measure("scramble (seen-mask, best)", scramble);
+    const auto unscramble_legacy = measure("unscramble (find_if, best)", legacy::unscramble);
+    const auto unscramble_mask = measure("unscramble (position table, best)", unscramble);
+
+    if (scramble_legacy != scramble_mask || unscramble_legacy != unscramble_mask) {
+        spdlog::error("byte maps differ between the implementations");
+        return 1;
+    }
+    print_timestamps(timestamps);
+    return 0;
+}
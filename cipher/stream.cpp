@@ -0,0 +1,97 @@
+#include "stream.h"
+
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "plf_nanotimer.h"
+
+void chunk_channel::push(chunk * c)
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        chunks.push(c);
+    }
+    ready.notify_one();
+}
+
+chunk * chunk_channel::pop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this] { return !chunks.empty(); });
+    chunk * c = chunks.front();
+    chunks.pop();
+    return c;
+}
+
+int stream_cipher(std::FILE * input, std::FILE * output, const size_t chunk_size, const size_t number_of_chunks, const std::function<void(std::byte *, size_t)> & transform, stream_stats & stats)
+{
+    std::vector<chunk> pool(number_of_chunks);
+    chunk_channel free_chunks;
+    chunk_channel filled_chunks;
+    chunk_channel transformed_chunks;
+    for (auto & c : pool) {
+        c.data.resize(chunk_size);
+        free_chunks.push(&c);
+    }
+    
+    bool read_failed = false;
+    bool write_failed = false;
+    
+    // reader: fills free chunks until the end of the input (marked by an empty chunk)
+    std::thread reader([&] {
+        plf::nanotimer timer;
+        for (;;) {
+            chunk * c = free_chunks.pop();
+            timer.start();
+            c->size = std::fread(c->data.data(), 1, chunk_size, input);
+            stats.read_ns += timer.get_elapsed_ns();
+            if (c->size < chunk_size && std::ferror(input)) {
+                read_failed = true;
+                c->size = 0;
+            }
+            filled_chunks.push(c);
+            if (c->size == 0) { break; }
+        }
+    });
+    
+    // writer: writes transformed chunks in order and recycles them (it keeps draining after errors,
+    // so that the other stages never wait for a chunk that does not come back)
+    std::thread writer([&] {
+        plf::nanotimer timer;
+        for (;;) {
+            chunk * c = transformed_chunks.pop();
+            if (c->size == 0) { break; }
+            if (!write_failed) {
+                timer.start();
+                write_failed = std::fwrite(c->data.data(), 1, c->size, output) != c->size;
+                stats.write_ns += timer.get_elapsed_ns();
+            }
+            free_chunks.push(c);
+        }
+        timer.start();
+        write_failed = std::fflush(output) != 0 || write_failed;
+        stats.write_ns += timer.get_elapsed_ns();
+    });
+    
+    // transformation on the calling thread (which may own a device queue)
+    plf::nanotimer timer;
+    for (;;) {
+        chunk * c = filled_chunks.pop();
+        if (c->size > 0) {
+            timer.start();
+            transform(c->data.data(), c->size);
+            stats.transform_ns += timer.get_elapsed_ns();
+            stats.bytes += c->size;
+            stats.chunks++;
+        }
+        transformed_chunks.push(c);
+        if (c->size == 0) { break; }
+    }
+    
+    reader.join();
+    writer.join();
+    if (read_failed) { spdlog::error("Error reading input stream"); }
+    if (write_failed) { spdlog::error("Error writing output stream"); }
+    return read_failed || write_failed ? 1 : 0;
+}
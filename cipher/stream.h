@@ -0,0 +1,76 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+// struct chunk
+// ------------
+// description: One piece of the message on its way through the pipeline.
+// A chunk with size 0 marks the end of the message.
+//
+struct chunk
+{
+    std::vector<std::byte> data;
+    size_t size{0};
+};
+
+// class chunk_channel
+// -------------------
+// description: A blocking queue of chunks between two stages of the pipeline.
+// It never holds more chunks than exist in the pipeline, so it needs no capacity of its own:
+// memory is bounded by the number of chunks the pipeline starts with.
+//
+class chunk_channel
+{
+public:
+    void push(chunk * c);
+    chunk * pop();
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::queue<chunk *> chunks;
+};
+
+// struct stream_stats
+// -------------------
+// description: Totals of a streaming run; busy times exclude the time a stage waits for the others.
+//
+struct stream_stats
+{
+    size_t bytes{0};
+    size_t chunks{0};
+    double read_ns{0};
+    double transform_ns{0};
+    double write_ns{0};
+};
+
+// function stream_cipher
+// ----------------------
+// inputs: the input and output files (e.g., stdin and stdout), the chunk size in bytes,
+//         the number of chunks in flight (2 for double, 3 for triple buffering),
+//         and the transformation applied to each chunk in place.
+//
+// output: Returns 1 if reading or writing fails, else 0.
+//
+// description: Three-stage pipeline: a reader thread fills free chunks, the calling thread
+// transforms them, and a writer thread writes them in order and hands them back to the reader.
+// Memory use is number_of_chunks * chunk_size regardless of the message size,
+// and the stages overlap, so the wall time approaches that of the slowest stage.
+//
+int stream_cipher(
+    std::FILE * input,
+    std::FILE * output,
+    size_t chunk_size,
+    size_t number_of_chunks,
+    const std::function<void(std::byte *, size_t)> & transform,
+    stream_stats & stats
+);
+
+#endif
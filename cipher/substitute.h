@@ -3,11 +3,13 @@
 
 #include <sycl/sycl.hpp>
 
-template <class Container>
+// note: The message containers may differ from the byte_map container
+// (e.g., pointers into memory-mapped files or accessors).
+template <class Container, class Input = Container, class Output = Container>
 SYCL_EXTERNAL void substitute(
     Container & byte_map,
-    Container & input_message,
-    Container & output_message,
+    Input & input_message,
+    Output & output_message,
     const size_t & input_message_size,
     const uint & grain_size,
     const size_t & i
@@ -16,9 +18,255 @@ SYCL_EXTERNAL void substitute(
     const auto start = i * grain_size;
     auto end = (i + 1) * grain_size;
     if (end > input_message_size) { end = input_message_size; }
-    for (int j = start; j < end; j++) {
+    for (size_t j = start; j < end; j++) {
         output_message[j] = byte_map[std::to_integer<uint8_t>(input_message[j])];
     }
 }
 
+// function substitute_tile
+// ------------------------
+// description: The nd_range counterpart of substitute: work-group group substitutes the contiguous tile of
+// work_group_size * grain_size bytes that starts at group * work_group_size * grain_size, where work item
+// local_id takes the bytes local_id, local_id + work_group_size, ... of the tile, so that neighbouring work
+// items load and store neighbouring bytes (coalesced) in every step.
+//
+template <class Map, class Input, class Output>
+SYCL_EXTERNAL void substitute_tile(
+    Map & byte_map,
+    Input & input_message,
+    Output & output_message,
+    const size_t & input_message_size,
+    const uint & grain_size,
+    const size_t & group,
+    const size_t & local_id,
+    const size_t & work_group_size
+)
+{
+    const auto tile_size = work_group_size * grain_size;
+    const auto start = group * tile_size;
+    auto end = start + tile_size;
+    if (end > input_message_size) { end = input_message_size; }
+    for (size_t j = start + local_id; j < end; j += work_group_size) {
+        output_message[j] = byte_map[std::to_integer<uint8_t>(input_message[j])];
+    }
+}
+
+// function submit_substitute_tiles
+// --------------------------------
+// description: Submits substitute_tile over the whole message as an nd_range kernel with one work-group
+// per tile. The work items of each work-group first copy the 256-byte byte_map into local memory together
+// and wait at a barrier, so that the lookups hit local memory instead of global memory.
+//
+inline sycl::event submit_substitute_tiles(
+    sycl::queue & Q,
+    sycl::buffer<std::byte> & byte_map_buf,
+    sycl::buffer<std::byte> & input_message_buf,
+    sycl::buffer<std::byte> & output_message_buf,
+    const size_t input_message_size,
+    const uint grain_size,
+    const size_t work_group_size
+)
+{
+    const auto tile_size{work_group_size * grain_size};
+    const auto number_of_tiles{std::max<size_t>(1, (input_message_size + tile_size - 1) / tile_size)};
+    return Q.submit([&](auto & h) {
+        const sycl::accessor byte_map_acc{byte_map_buf, h, sycl::read_only};
+        const sycl::accessor input_message_acc{input_message_buf, h, sycl::read_only};
+        const sycl::accessor output_message_acc{output_message_buf, h, sycl::write_only, sycl::no_init};
+        const sycl::local_accessor<std::byte, 1> local_map{sycl::range<1>{256}, h};
+        h.parallel_for(sycl::nd_range<1>{number_of_tiles * work_group_size, work_group_size}, [=](const auto & item) {
+            for (size_t k = item.get_local_id(0); k < 256; k += item.get_local_range(0)) {
+                local_map[k] = byte_map_acc[k];
+            }
+            sycl::group_barrier(item.get_group());
+            substitute_tile(local_map, input_message_acc, output_message_acc, input_message_size, grain_size, item.get_group_linear_id(), item.get_local_id(0), item.get_local_range(0));
+        });
+    });
+}
+
+// note: The same for USM pointers (see --memory), after the events in depends_on (e.g., the copies to the device).
+inline sycl::event submit_substitute_tiles(
+    sycl::queue & Q,
+    const std::byte * byte_map,
+    const std::byte * input_message,
+    std::byte * output_message,
+    const size_t input_message_size,
+    const uint grain_size,
+    const size_t work_group_size,
+    const std::vector<sycl::event> & depends_on
+)
+{
+    const auto tile_size{work_group_size * grain_size};
+    const auto number_of_tiles{std::max<size_t>(1, (input_message_size + tile_size - 1) / tile_size)};
+    return Q.submit([&](auto & h) {
+        h.depends_on(depends_on);
+        const sycl::local_accessor<std::byte, 1> local_map{sycl::range<1>{256}, h};
+        h.parallel_for(sycl::nd_range<1>{number_of_tiles * work_group_size, work_group_size}, [=](const auto & item) {
+            for (size_t k = item.get_local_id(0); k < 256; k += item.get_local_range(0)) {
+                local_map[k] = byte_map[k];
+            }
+            sycl::group_barrier(item.get_group());
+            substitute_tile(local_map, input_message, output_message, input_message_size, grain_size, item.get_group_linear_id(), item.get_local_id(0), item.get_local_range(0));
+        });
+    });
+}
+
+// function substitute_words
+// -------------------------
+// description: The same as substitute for the simd engine on devices, where the message is padded
+// to whole 16-byte words: each work item loads and stores grain_size words as vectors and
+// looks up their 16 bytes in the byte_map.
+//
+template <class Map, class Words>
+SYCL_EXTERNAL void substitute_words(
+    Map & byte_map,
+    Words & input_words,
+    Words & output_words,
+    const size_t & number_of_words,
+    const uint & grain_size,
+    const size_t & i
+)
+{
+    const auto start = i * grain_size;
+    auto end = (i + 1) * grain_size;
+    if (end > number_of_words) { end = number_of_words; }
+    for (size_t w = start; w < end; w++) {
+        const sycl::uchar16 word = input_words[w];
+        sycl::uchar16 result;
+        for (int k = 0; k < 16; k++) {
+            result[k] = std::to_integer<uint8_t>(byte_map[word[k]]);
+        }
+        output_words[w] = result;
+    }
+}
+
+// function job_of
+// ---------------
+// description: Index of the batch job that owns byte j of the concatenated messages
+// (binary search over the job_begin offsets, see batch.h); empty jobs never own a byte.
+//
+template <class Offsets>
+SYCL_EXTERNAL size_t job_of(
+    Offsets & job_begin,
+    const size_t & number_of_jobs,
+    const size_t & j
+)
+{
+    size_t low = 0;
+    size_t high = number_of_jobs;
+    while (high - low > 1) {
+        const auto middle = low + (high - low) / 2;
+        if (job_begin[middle] <= j) { low = middle; }
+        else { high = middle; }
+    }
+    return low;
+}
+
+// function substitute_batch
+// -------------------------
+// description: The same as substitute for the concatenated messages of a batch, where each byte is
+// looked up in the map of its job in the packed 256 x K byte_maps table. A work item finds the job
+// of its first byte once and moves on to the next job when its grain crosses a job boundary.
+//
+template <class Maps, class Jobs, class Offsets, class Input, class Output>
+SYCL_EXTERNAL void substitute_batch(
+    Maps & byte_maps,
+    Jobs & job_map,
+    Offsets & job_begin,
+    const size_t & number_of_jobs,
+    Input & input_messages,
+    Output & output_messages,
+    const size_t & input_messages_size,
+    const uint & grain_size,
+    const size_t & i
+)
+{
+    const auto start = i * grain_size;
+    auto end = (i + 1) * grain_size;
+    if (end > input_messages_size) { end = input_messages_size; }
+    if (start >= end) { return; }
+    auto job = job_of(job_begin, number_of_jobs, start);
+    auto map = 256 * static_cast<size_t>(job_map[job]);
+    for (size_t j = start; j < end; j++) {
+        while (j >= job_begin[job + 1]) {
+            job++;
+            map = 256 * static_cast<size_t>(job_map[job]);
+        }
+        output_messages[j] = byte_maps[map + std::to_integer<uint8_t>(input_messages[j])];
+    }
+}
+
+// function substitute_periodic
+// ----------------------------
+// description: The same as substitute for the polyalphabetic mode, where byte j is looked up in
+// map j % period of the period x 256 byte_maps table (see scramble_polyalphabetic). The map index is
+// computed once per work item and then advanced with the position, without a division per byte.
+//
+template <class Maps, class Input, class Output>
+SYCL_EXTERNAL void substitute_periodic(
+    Maps & byte_maps,
+    const size_t & period,
+    Input & input_message,
+    Output & output_message,
+    const size_t & input_message_size,
+    const uint & grain_size,
+    const size_t & i
+)
+{
+    const auto start = i * grain_size;
+    auto end = (i + 1) * grain_size;
+    if (end > input_message_size) { end = input_message_size; }
+    auto map = start % period;
+    for (size_t j = start; j < end; j++) {
+        output_message[j] = byte_maps[256 * map + std::to_integer<uint8_t>(input_message[j])];
+        if (++map == period) { map = 0; }
+    }
+}
+
+// function submit_substitute_periodic
+// -----------------------------------
+// description: Submits substitute_periodic over the whole message. With stage_in_local_memory, it runs as an
+// nd_range kernel where the work items of each work-group first copy the period x 256 table from global into
+// local memory together (strided, so that neighbouring work items load neighbouring bytes) and wait at a barrier,
+// so that the lookups hit local memory; the table must fit into the local memory of the device.
+// Without it, the lookups go to the table in global memory (for comparison and for larger tables).
+//
+inline sycl::event submit_substitute_periodic(
+    sycl::queue & Q,
+    sycl::buffer<std::byte> & byte_maps_buf,
+    const size_t period,
+    sycl::buffer<std::byte> & input_message_buf,
+    sycl::buffer<std::byte> & output_message_buf,
+    const size_t input_message_size,
+    const uint grain_size,
+    const size_t work_group_size,
+    const bool stage_in_local_memory
+)
+{
+    const auto work_load{input_message_size / grain_size + 1};
+    return Q.submit([&](auto & h) {
+        const sycl::accessor byte_maps_acc{byte_maps_buf, h, sycl::read_only};
+        const sycl::accessor input_message_acc{input_message_buf, h, sycl::read_only};
+        const sycl::accessor output_message_acc{output_message_buf, h, sycl::write_only, sycl::no_init};
+        if (stage_in_local_memory) {
+            // the work items beyond the work load (up to whole work-groups) only help with the copy
+            const auto table_size{256 * period};
+            const auto global_size{(work_load + work_group_size - 1) / work_group_size * work_group_size};
+            const sycl::local_accessor<std::byte, 1> local_maps{sycl::range<1>{table_size}, h};
+            h.parallel_for(sycl::nd_range<1>{global_size, work_group_size}, [=](const auto & item) {
+                for (size_t k = item.get_local_id(0); k < table_size; k += item.get_local_range(0)) {
+                    local_maps[k] = byte_maps_acc[k];
+                }
+                sycl::group_barrier(item.get_group());
+                substitute_periodic(local_maps, period, input_message_acc, output_message_acc, input_message_size, grain_size, item.get_global_id(0));
+            });
+        }
+        else {
+            h.parallel_for(work_load, [=](const auto & i) {
+                substitute_periodic(byte_maps_acc, period, input_message_acc, output_message_acc, input_message_size, grain_size, i);
+            });
+        }
+    });
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "substitute_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SUBSTITUTE_SIMD_X86
+#endif
+
+namespace {
+
+void substitute_scalar(const std::byte * byte_map, const std::byte * input_message, std::byte * output_message, const size_t begin, const size_t end)
+{
+    for (size_t j = begin; j < end; j++) {
+        output_message[j] = byte_map[std::to_integer<uint8_t>(input_message[j])];
+    }
+}
+
+#ifdef SUBSTITUTE_SIMD_X86
+
+// 16 bytes per step: result = OR over all high nibbles h of (high == h) & pshufb(row h, low)
+__attribute__((target("ssse3")))
+size_t substitute_ssse3(const std::byte * byte_map, const std::byte * input_message, std::byte * output_message, const size_t size)
+{
+    __m128i rows[16];
+    for (int h = 0; h < 16; h++) {
+        rows[h] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_map + 16 * h));
+    }
+    const auto low_mask = _mm_set1_epi8(0x0f);
+    size_t j = 0;
+    for (; j + 16 <= size; j += 16) {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input_message + j));
+        const auto low = _mm_and_si128(x, low_mask);
+        const auto high = _mm_and_si128(_mm_srli_epi16(x, 4), low_mask);
+        auto result = _mm_setzero_si128();
+        for (int h = 0; h < 16; h++) {
+            const auto selected = _mm_cmpeq_epi8(high, _mm_set1_epi8(static_cast<char>(h)));
+            result = _mm_or_si128(result, _mm_and_si128(selected, _mm_shuffle_epi8(rows[h], low)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output_message + j), result);
+    }
+    return j;
+}
+
+// the same as SSSE3 on 32 bytes (vpshufb looks up within each 128-bit half, so the rows are broadcast)
+__attribute__((target("avx2")))
+size_t substitute_avx2(const std::byte * byte_map, const std::byte * input_message, std::byte * output_message, const size_t size)
+{
+    __m256i rows[16];
+    for (int h = 0; h < 16; h++) {
+        rows[h] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_map + 16 * h)));
+    }
+    const auto low_mask = _mm256_set1_epi8(0x0f);
+    size_t j = 0;
+    for (; j + 32 <= size; j += 32) {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input_message + j));
+        const auto low = _mm256_and_si256(x, low_mask);
+        const auto high = _mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask);
+        auto result = _mm256_setzero_si256();
+        for (int h = 0; h < 16; h++) {
+            const auto selected = _mm256_cmpeq_epi8(high, _mm256_set1_epi8(static_cast<char>(h)));
+            result = _mm256_or_si256(result, _mm256_and_si256(selected, _mm256_shuffle_epi8(rows[h], low)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output_message + j), result);
+    }
+    return j;
+}
+
+// 64 bytes per step: vpermi2b looks up 7-bit indices in 128 entries, and the top bit selects the half of the byte_map
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+size_t substitute_avx512vbmi(const std::byte * byte_map, const std::byte * input_message, std::byte * output_message, const size_t size)
+{
+    const auto map0 = _mm512_loadu_si512(byte_map);
+    const auto map1 = _mm512_loadu_si512(byte_map + 64);
+    const auto map2 = _mm512_loadu_si512(byte_map + 128);
+    const auto map3 = _mm512_loadu_si512(byte_map + 192);
+    size_t j = 0;
+    for (; j + 64 <= size; j += 64) {
+        const auto x = _mm512_loadu_si512(input_message + j);
+        const auto lower = _mm512_permutex2var_epi8(map0, x, map1);
+        const auto upper = _mm512_permutex2var_epi8(map2, x, map3);
+        const auto result = _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), lower, upper);
+        _mm512_storeu_si512(output_message + j, result);
+    }
+    return j;
+}
+
+#endif
+
+} // namespace
+
+void substitute_simd(const std::vector<std::byte> & byte_map, const std::byte * input_message, std::byte * output_message, const size_t size)
+{
+    size_t done = 0;
+#ifdef SUBSTITUTE_SIMD_X86
+    if (byte_map.size() < 256) {
+        // partial maps (e.g., a narrower decimal range) only work with the scalar loop
+    } else if (__builtin_cpu_supports("avx512vbmi")) {
+        done = substitute_avx512vbmi(byte_map.data(), input_message, output_message, size);
+    } else if (__builtin_cpu_supports("avx2")) {
+        done = substitute_avx2(byte_map.data(), input_message, output_message, size);
+    } else if (__builtin_cpu_supports("ssse3")) {
+        done = substitute_ssse3(byte_map.data(), input_message, output_message, size);
+    }
+#endif
+    substitute_scalar(byte_map.data(), input_message, output_message, done, size);
+}
+
+std::string simd_instruction_set()
+{
+#ifdef SUBSTITUTE_SIMD_X86
+    if (__builtin_cpu_supports("avx512vbmi")) { return "avx512vbmi"; }
+    if (__builtin_cpu_supports("avx2")) { return "avx2"; }
+    if (__builtin_cpu_supports("ssse3")) { return "ssse3"; }
+#endif
+    return "scalar";
+}
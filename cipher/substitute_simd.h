@@ -0,0 +1,31 @@
+#ifndef SUBSTITUTE_SIMD_H_
+#define SUBSTITUTE_SIMD_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// function substitute_simd
+// ------------------------
+// inputs: a byte_map of 256 bytes, the input message, the output message, and the number of bytes to substitute.
+//
+// output: void; output_message[j] = byte_map[input_message[j]] for all j < size.
+//
+// description: Host substitution on whole vectors instead of one table lookup per byte.
+// The widest instruction set supported by the CPU is selected at runtime:
+// AVX-512 VBMI (64 bytes: two 128-entry permutes), AVX2 (32 bytes) or SSSE3 (16 bytes),
+// where the latter two split each byte into nibbles and look up the low nibble with pshufb
+// in the 16-entry row of the byte_map selected by the high nibble.
+// The remaining bytes and other CPUs use the scalar loop.
+//
+void substitute_simd(
+    const std::vector<std::byte> & byte_map,
+    const std::byte * input_message,
+    std::byte * output_message,
+    size_t size
+);
+
+// name of the instruction set used by substitute_simd on this CPU (e.g., for the device name in the timestamps)
+std::string simd_instruction_set();
+
+#endif
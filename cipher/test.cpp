@@ -7,6 +7,12 @@
 #include "scramble.h"
 #include "file_ops.h"
 #include "substitute.h"
+#include "substitute_simd.h"
+#include "stream.h"
+#include "batch.h"
+
+#include <random>
+#include <fmt/format.h>
 
 class CipherTest : public testing::Test {
     public:
@@ -76,4 +82,281 @@ TEST_F(CipherTest, TestUnscramble) {
         ASSERT_EQ(temp_plaintext[i], plaintext[i]);
     }
     
-}
\ No newline at end of file
+}
+
+TEST_F(CipherTest, TestScrambleSimd) {
+    EXPECT_EQ(plaintext.size(), ciphertext.size());
+    
+    std::vector<std::byte> byte_map = scramble(key, decimal_begin, decimal_end);
+    std::vector<std::byte> temp_ciphertext{ciphertext.size()};
+    
+    substitute_simd(byte_map, plaintext.data(), temp_ciphertext.data(), plaintext.size());
+    
+    for (int i = 0; i < ciphertext.size(); i++) {
+        ASSERT_EQ(temp_ciphertext[i], ciphertext[i]);
+    }
+}
+
+TEST_F(CipherTest, TestUnscrambleSimd) {
+    EXPECT_EQ(plaintext.size(), ciphertext.size());
+    
+    std::vector<std::byte> byte_map = unscramble(key, decimal_begin, decimal_end);
+    std::vector<std::byte> temp_plaintext{plaintext.size()};
+    
+    substitute_simd(byte_map, ciphertext.data(), temp_plaintext.data(), ciphertext.size());
+    
+    for (int i = 0; i < plaintext.size(); i++) {
+        ASSERT_EQ(temp_plaintext[i], plaintext[i]);
+    }
+}
+
+// independent of the test data: all byte values and every length of the remainder after the widest vector
+TEST_F(CipherTest, TestSimdMatchesScalar) {
+    std::mt19937 generator{42};
+    std::vector<std::byte> random_key(300);
+    for (auto & b : random_key) { b = static_cast<std::byte>(generator()); }
+    const std::vector<std::byte> byte_map = scramble(random_key, decimal_begin, decimal_end);
+    
+    for (size_t size = 0; size <= 200; size++) {
+        std::vector<std::byte> message(size);
+        for (auto & b : message) { b = static_cast<std::byte>(generator()); }
+        std::vector<std::byte> expected(size);
+        std::vector<std::byte> actual(size);
+        for (int i = 0; i < size + 1; i++) {
+            substitute<std::vector<std::byte>>(const_cast<std::vector<std::byte>&>(byte_map), message, expected, size, 1, i);
+        }
+        substitute_simd(byte_map, message.data(), actual.data(), size);
+        ASSERT_EQ(actual, expected) << "size " << size;
+    }
+}
+
+TEST_F(CipherTest, TestMappedFiles) {
+    const std::string path = testing::TempDir() + "cipher-mapped-file-test.bin";
+    const std::vector<std::byte> message{std::byte{72}, std::byte{101}, std::byte{108}, std::byte{108}, std::byte{111}, std::byte{33}};
+    {
+        mapped_file output_map;
+        ASSERT_EQ(map_for_writing(output_map, path, message.size()), 0);
+        ASSERT_EQ(output_map.size(), message.size());
+        std::copy(message.begin(), message.end(), output_map.data());
+        ASSERT_EQ(output_map.sync(), 0);
+    }
+    
+    std::vector<std::byte> read_back;
+    ASSERT_EQ(read_from_binary(read_back, path), 0);
+    EXPECT_EQ(read_back, message);
+    
+    mapped_file input_map;
+    ASSERT_EQ(map_for_reading(input_map, path), 0);
+    ASSERT_EQ(input_map.size(), message.size());
+    EXPECT_TRUE(std::equal(message.begin(), message.end(), input_map.data()));
+    
+    EXPECT_EQ(map_for_reading(input_map, path + ".missing"), 1);
+    EXPECT_TRUE(same_file(path, path));
+    EXPECT_TRUE(same_file(path, testing::TempDir() + "./cipher-mapped-file-test.bin"));
+    EXPECT_FALSE(same_file(path, path + ".missing"));
+    std::remove(path.c_str());
+}
+
+
+
+TEST_F(CipherTest, TestStream) {
+    std::mt19937 generator{7};
+    std::vector<std::byte> message(1000);
+    for (auto & b : message) { b = static_cast<std::byte>(generator()); }
+    const std::vector<std::byte> byte_map = scramble(message, decimal_begin, decimal_end);
+    std::vector<std::byte> expected(message.size());
+    substitute_simd(byte_map, message.data(), expected.data(), message.size());
+    
+    // chunk sizes that divide the message, leave a remainder, and exceed it
+    for (const size_t chunk_size : {100, 64, 4096}) {
+        std::FILE * input = std::tmpfile();
+        std::FILE * output = std::tmpfile();
+        ASSERT_NE(input, nullptr);
+        ASSERT_NE(output, nullptr);
+        std::fwrite(message.data(), 1, message.size(), input);
+        std::rewind(input);
+        
+        stream_stats stats;
+        const auto status = stream_cipher(input, output, chunk_size, 2, [&](std::byte * data, size_t size) {
+            substitute_simd(byte_map, data, data, size);
+        }, stats);
+        ASSERT_EQ(status, 0);
+        EXPECT_EQ(stats.bytes, message.size());
+        EXPECT_EQ(stats.chunks, (message.size() + chunk_size - 1) / chunk_size);
+        
+        std::vector<std::byte> actual(message.size() + 1);
+        std::rewind(output);
+        ASSERT_EQ(std::fread(actual.data(), 1, actual.size(), output), message.size());
+        actual.resize(message.size());
+        EXPECT_EQ(actual, expected) << "chunk size " << chunk_size;
+        std::fclose(input);
+        std::fclose(output);
+    }
+}
+
+TEST_F(CipherTest, TestByteMapConstruction) {
+    // the example in scramble.cpp
+    const std::vector<std::byte> example{std::byte{67}, std::byte{121}, std::byte{110}, std::byte{64}, std::byte{33}, std::byte{67}};
+    const auto example_map = scramble(example, decimal_begin, decimal_end);
+    ASSERT_EQ(example_map.size(), 256);
+    EXPECT_EQ(example_map[4], std::byte{33});
+    EXPECT_EQ(example_map[5], std::byte{0});
+    EXPECT_EQ(example_map[255], std::byte{255});
+    EXPECT_EQ(unscramble(example, decimal_begin, decimal_end)[33], std::byte{4});
+    
+    // unscramble inverts scramble for keys of any length (with many duplicates)
+    std::mt19937 generator{3};
+    for (const size_t key_size : {0, 1, 17, 256, 100000}) {
+        std::vector<std::byte> random_key(key_size);
+        for (auto & b : random_key) { b = static_cast<std::byte>(generator()); }
+        const auto forward = scramble(random_key, decimal_begin, decimal_end);
+        const auto backward = unscramble(random_key, decimal_begin, decimal_end);
+        ASSERT_EQ(forward.size(), 256);
+        ASSERT_EQ(backward.size(), 256);
+        for (int i = 0; i < 256; i++) {
+            ASSERT_EQ(backward[std::to_integer<uint8_t>(forward[i])], static_cast<std::byte>(i)) << "key size " << key_size;
+        }
+    }
+    
+    // compile-time keys
+    constexpr auto constant_map = scramble_array(std::array{std::byte{67}, std::byte{121}, std::byte{110}, std::byte{64}, std::byte{33}});
+    static_assert(constant_map[0] == std::byte{67} && constant_map[5] == std::byte{0});
+    constexpr auto constant_inverse = unscramble_array(std::array{std::byte{67}, std::byte{121}, std::byte{110}, std::byte{64}, std::byte{33}});
+    static_assert(constant_inverse[67] == std::byte{0} && constant_inverse[0] == std::byte{5});
+    EXPECT_TRUE(std::equal(constant_map.begin(), constant_map.end(), example_map.begin()));
+}
+
+TEST_F(CipherTest, TestBatch) {
+    const std::string directory = testing::TempDir();
+    std::mt19937 generator{11};
+    std::vector<std::byte> other_key(40);
+    for (auto & b : other_key) { b = static_cast<std::byte>(generator()); }
+    std::vector<std::byte> small_message(13);
+    for (auto & b : small_message) { b = static_cast<std::byte>(generator()); }
+    const std::vector<std::byte> empty_message;
+    
+    // the test data under paths without spaces, as the manifest requires
+    ASSERT_EQ(write_to_binary(plaintext, directory + "batch-plaintext.txt"), 0);
+    ASSERT_EQ(write_to_binary(ciphertext, directory + "batch-ciphertext.txt"), 0);
+    ASSERT_EQ(write_to_binary(key, directory + "batch-key.txt"), 0);
+    ASSERT_EQ(write_to_binary(other_key, directory + "batch-other-key.txt"), 0);
+    ASSERT_EQ(write_to_binary(small_message.data(), small_message.size(), directory + "batch-small.txt"), 0);
+    ASSERT_EQ(write_to_binary(empty_message.data(), 0, directory + "batch-empty.txt"), 0);
+    
+    const std::string manifest_path = directory + "batch-manifest.txt";
+    std::FILE * manifest = std::fopen(manifest_path.c_str(), "w");
+    ASSERT_NE(manifest, nullptr);
+    fmt::print(manifest, "# direction input output key\n\n");
+    fmt::print(manifest, "encode {0}batch-plaintext.txt {0}batch-out-0.txt {0}batch-key.txt\n", directory);
+    fmt::print(manifest, "decode {0}batch-ciphertext.txt {0}batch-out-1.txt {0}batch-key.txt\n", directory);
+    fmt::print(manifest, "  encode {0}batch-empty.txt {0}batch-out-2.txt {0}batch-key.txt\n", directory);
+    fmt::print(manifest, "encode {0}batch-small.txt {0}batch-out-3.txt {0}batch-other-key.txt\n", directory);
+    fmt::print(manifest, "encode {0}batch-small.txt {0}batch-out-4.txt {0}batch-key.txt\n", directory);
+    std::fclose(manifest);
+    
+    std::vector<batch_job> jobs;
+    ASSERT_EQ(read_manifest(jobs, manifest_path), 0);
+    ASSERT_EQ(jobs.size(), 5);
+    EXPECT_FALSE(jobs[1].encode);
+    
+    batch packed;
+    ASSERT_EQ(pack_batch(jobs, packed), 0);
+    // one map per (key, direction): the key encoding, the key decoding, and the other key encoding
+    EXPECT_EQ(packed.byte_maps.size(), 3 * 256);
+    EXPECT_EQ(packed.job_map, (std::vector<uint32_t>{0, 1, 0, 2, 0}));
+    EXPECT_EQ(packed.job_begin.back(), plaintext.size() + ciphertext.size() + 2 * small_message.size());
+    
+    // the expected output of each job with its own byte map
+    const std::vector<std::vector<std::byte>> messages{plaintext, ciphertext, empty_message, small_message, small_message};
+    const std::vector<std::vector<std::byte>> maps{
+        scramble(key, decimal_begin, decimal_end), unscramble(key, decimal_begin, decimal_end), scramble(key, decimal_begin, decimal_end),
+        scramble(other_key, decimal_begin, decimal_end), scramble(key, decimal_begin, decimal_end)
+    };
+    std::vector<std::byte> expected;
+    for (size_t j = 0; j < messages.size(); j++) {
+        for (const auto b : messages[j]) { expected.push_back(maps[j][std::to_integer<uint8_t>(b)]); }
+    }
+    
+    // grain sizes within a job and across job boundaries
+    const auto size = packed.messages.size();
+    for (const uint batch_grain_size : {1u, 7u, 4096u}) {
+        std::vector<std::byte> actual(size);
+        for (size_t i = 0; i < size / batch_grain_size + 1; i++) {
+            substitute_batch(packed.byte_maps, packed.job_map, packed.job_begin, jobs.size(), packed.messages, actual, size, batch_grain_size, i);
+        }
+        ASSERT_EQ(actual, expected) << "grain size " << batch_grain_size;
+    }
+    
+    ASSERT_EQ(write_batch(jobs, packed, expected.data()), 0);
+    std::vector<std::byte> output;
+    ASSERT_EQ(read_from_binary(output, directory + "batch-out-0.txt"), 0);
+    EXPECT_EQ(output, ciphertext);
+    ASSERT_EQ(read_from_binary(output, directory + "batch-out-1.txt"), 0);
+    EXPECT_EQ(output, plaintext);
+    ASSERT_EQ(read_from_binary(output, directory + "batch-out-2.txt"), 0);
+    EXPECT_TRUE(output.empty());
+    
+    // malformed lines are rejected
+    manifest = std::fopen(manifest_path.c_str(), "w");
+    ASSERT_NE(manifest, nullptr);
+    fmt::print(manifest, "scramble {0}batch-small.txt {0}batch-out-3.txt {0}batch-key.txt\n", directory);
+    std::fclose(manifest);
+    jobs.clear();
+    EXPECT_EQ(read_manifest(jobs, manifest_path), 1);
+}
+
+TEST_F(CipherTest, TestPolyalphabetic) {
+    for (const size_t period : {1, 5, 256, 300}) {
+        const auto forward = scramble_polyalphabetic(key, period);
+        const auto backward = unscramble_polyalphabetic(key, period);
+        ASSERT_EQ(forward.size(), 256 * period);
+        ASSERT_EQ(backward.size(), 256 * period);
+        
+        // each map is inverted by the map at the same position
+        for (size_t p = 0; p < period; p++) {
+            for (int b = 0; b < 256; b++) {
+                ASSERT_EQ(backward[256 * p + std::to_integer<uint8_t>(forward[256 * p + b])], static_cast<std::byte>(b)) << "map " << p;
+            }
+        }
+        
+        // grain sizes that split the message at any map, and round trips
+        const auto size = plaintext.size();
+        for (const uint periodic_grain_size : {1u, 7u, 1000u}) {
+            std::vector<std::byte> encoded(size);
+            std::vector<std::byte> decoded(size);
+            for (size_t i = 0; i < size / periodic_grain_size + 1; i++) {
+                substitute_periodic(forward, period, plaintext, encoded, size, periodic_grain_size, i);
+            }
+            for (size_t j = 0; j < size; j++) {
+                ASSERT_EQ(encoded[j], forward[256 * (j % period) + std::to_integer<uint8_t>(plaintext[j])]);
+            }
+            for (size_t i = 0; i < size / periodic_grain_size + 1; i++) {
+                substitute_periodic(backward, period, encoded, decoded, size, periodic_grain_size, i);
+            }
+            ASSERT_EQ(decoded, plaintext) << "period " << period << ", grain size " << periodic_grain_size;
+        }
+    }
+    
+    // equal plaintext bytes at different positions become different ciphertext bytes
+    const auto byte_maps = scramble_polyalphabetic(std::vector<std::byte>{std::byte{1}, std::byte{2}}, 2);
+    EXPECT_NE(byte_maps[65], byte_maps[256 + 65]);
+}
+
+TEST_F(CipherTest, TestTiles) {
+    const auto size = plaintext.size();
+    std::vector<std::byte> byte_map = scramble(key, decimal_begin, decimal_end);
+    
+    // every work item of every work-group, as the nd_range kernel runs them
+    for (const size_t work_group_size : {1, 32, 256}) {
+        for (const uint tile_grain_size : {1u, 3u, 64u}) {
+            std::vector<std::byte> actual(size);
+            const auto tile_size = work_group_size * tile_grain_size;
+            for (size_t group = 0; group < (size + tile_size - 1) / tile_size; group++) {
+                for (size_t local_id = 0; local_id < work_group_size; local_id++) {
+                    substitute_tile(byte_map, plaintext, actual, size, tile_grain_size, group, local_id, work_group_size);
+                }
+            }
+            ASSERT_EQ(actual, ciphertext) << "work-group size " << work_group_size << ", grain size " << tile_grain_size;
+        }
+    }
+}
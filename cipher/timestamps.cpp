@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdio>
 #include <fmt/format.h>
 #include <sycl/sycl.hpp>
@@ -11,9 +12,41 @@ void mark_time(std::vector<std::tuple<std::string, double>> & timestamps, double
 }
 
 // new print -> using plf_nanotimer
-void print_timestamps(std::vector<std::tuple<std::string, double>> & timestamps) {
-    std::for_each(timestamps.begin(), timestamps.end(), [](const auto & tuple) {
-        fmt::print("{},{}", std::get<0>(tuple), std::get<1>(tuple));
-        fmt::print("\n");
+void print_timestamps(std::vector<std::tuple<std::string, double>> & timestamps, std::FILE * output) {
+    std::for_each(timestamps.begin(), timestamps.end(), [output](const auto & tuple) {
+        fmt::print(output, "{},{}", std::get<0>(tuple), std::get<1>(tuple));
+        fmt::print(output, "\n");
     });
-}
\ No newline at end of file
+}
+
+// event times -> using sycl event profiling
+double mark_event_times(std::vector<std::tuple<std::string, double>> & timestamps, const std::vector<sycl::event> & events, const std::string_view label) {
+    double queue_wait = 0;
+    double execute = 0;
+    uint64_t first_start = 0;
+    uint64_t previous_end = 0;
+    for (const auto & event : events) {
+        const auto submit = event.get_profiling_info<sycl::info::event_profiling::command_submit>();
+        const auto start = event.get_profiling_info<sycl::info::event_profiling::command_start>();
+        const auto end = event.get_profiling_info<sycl::info::event_profiling::command_end>();
+        if (&event == &events.front()) { first_start = start; }
+        const auto ready = std::max<uint64_t>(submit, previous_end);
+        queue_wait += start > ready ? start - ready : 0;
+        execute += end - start;
+        previous_end = std::max<uint64_t>(previous_end, end);
+    }
+    mark_time(timestamps, queue_wait, std::string(label) + " queue wait");
+    mark_time(timestamps, execute, std::string(label) + " execute");
+    if (events.size() > 1) {
+        double span = previous_end - first_start;
+        mark_time(timestamps, span, std::string(label) + " span");
+    }
+    return execute;
+}
+
+// bandwidth -> from a time of mark_time or mark_event_times
+void mark_bandwidth(std::vector<std::tuple<std::string, double>> & timestamps, const double bytes, const double time_ns, const std::string_view label) {
+    if (bytes == 0 || time_ns == 0) { return; }
+    double bandwidth = bytes / time_ns;
+    mark_time(timestamps, bandwidth, std::string(label) + " (GB/s)");
+}
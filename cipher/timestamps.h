@@ -1,14 +1,29 @@
 #ifndef CIPHER_TIMESTAMPS_H
 #define CIPHER_TIMESTAMPS_H
 
+#include <sycl/sycl.hpp>
+
 #include <vector>
 #include <unordered_map>
 #include <chrono>
+#include <cstdio>
 
 // mark_time using nanotimer
 void mark_time(std::vector<std::tuple<std::string, double>> & timestamps, double & timestamp, std::string_view label);
 
-// print_timestamps using nanotimer
-void print_timestamps(std::vector<std::tuple<std::string, double>> & timestamps);
+// print_timestamps using nanotimer (to stderr when the output message goes to stdout)
+void print_timestamps(std::vector<std::tuple<std::string, double>> & timestamps, std::FILE * output = stdout);
+
+// mark_event_times using SYCL event profiling (the queue needs sycl::property::queue::enable_profiling):
+// "<label> execute" from command_start to command_end, summed over the events, and "<label> queue wait",
+// the time each event waited to start after its command_submit or after the end of the previous event,
+// whichever is later (so that a chain of kernels on an in-order queue does not count earlier kernels as wait);
+// for several events also "<label> span" from the first command_start to the last command_end;
+// returns the execute time
+double mark_event_times(std::vector<std::tuple<std::string, double>> & timestamps, const std::vector<sycl::event> & events, std::string_view label);
+
+// mark_bandwidth: bytes read plus bytes written per nanosecond as "<label> (GB/s)";
+// no row when the size or the time is zero (e.g., an empty message), so that no inf or nan is printed
+void mark_bandwidth(std::vector<std::tuple<std::string, double>> & timestamps, double bytes, double time_ns, std::string_view label);
 
 #endif
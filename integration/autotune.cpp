@@ -0,0 +1,93 @@
+#include "autotune.h"
+
+#include <fstream>
+#include <sstream>
+
+std::vector<size_t> geometric_candidates(const size_t max_grain_size, const size_t factor) {
+    std::vector<size_t> candidates;
+    for (size_t grain_size{1}; grain_size < max_grain_size; grain_size *= factor) {
+        candidates.push_back(grain_size);
+        if (grain_size > max_grain_size / factor) {
+            break;
+        }
+    }
+    candidates.push_back(max_grain_size);
+    return candidates;
+}
+
+std::vector<size_t> refinement_candidates(const size_t best, const size_t max_grain_size, const size_t factor) {
+    // halfway (geometrically) to the neighbors, plus the immediate neighbors at twice the resolution
+    std::vector<size_t> candidates;
+    const auto add{[&](const size_t grain_size) {
+        if (grain_size >= 1 && grain_size <= max_grain_size && grain_size != best
+            && std::find(candidates.begin(), candidates.end(), grain_size) == candidates.end()) {
+            candidates.push_back(grain_size);
+        }
+    }};
+    if (factor >= 4) {
+        add(best / 2);
+        add(best * 2);
+    }
+    add(best * 2 / 3);
+    add(best * 3 / 2);
+    return candidates;
+}
+
+namespace {
+
+struct cache_entry {
+    std::string device_name;
+    size_t total_workload;
+    std::string method_name;
+    size_t grain_size;
+};
+
+std::vector<cache_entry> read_cache(const std::string & path) {
+    std::vector<cache_entry> entries;
+    std::ifstream input{path};
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream fields{line};
+        cache_entry entry;
+        std::string workload, grain_size;
+        if (std::getline(fields, entry.device_name, '\t') && std::getline(fields, workload, '\t')
+            && std::getline(fields, entry.method_name, '\t') && std::getline(fields, grain_size)) {
+            try {
+                entry.total_workload = std::stoull(workload);
+                entry.grain_size = std::stoull(grain_size);
+                entries.push_back(entry);
+            } catch (const std::logic_error &) {
+                // skip malformed lines
+            }
+        }
+    }
+    return entries;
+}
+
+} // namespace
+
+std::optional<size_t> lookup_grain_size(const std::string & path, const std::string & device_name, const size_t total_workload, const std::string & method_name) {
+    for (const auto & entry : read_cache(path)) {
+        if (entry.device_name == device_name && entry.total_workload == total_workload && entry.method_name == method_name) {
+            return entry.grain_size;
+        }
+    }
+    return std::nullopt;
+}
+
+bool store_grain_size(const std::string & path, const std::string & device_name, const size_t total_workload, const std::string & method_name, const size_t grain_size) {
+    auto entries{read_cache(path)};
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const auto & entry) {
+        return entry.device_name == device_name && entry.total_workload == total_workload && entry.method_name == method_name;
+    }), entries.end());
+    entries.push_back(cache_entry{device_name, total_workload, method_name, grain_size});
+
+    std::ofstream output{path};
+    if (! output.is_open()) {
+        return false;
+    }
+    for (const auto & entry : entries) {
+        output << entry.device_name << '\t' << entry.total_workload << '\t' << entry.method_name << '\t' << entry.grain_size << '\n';
+    }
+    return output.good();
+}
@@ -0,0 +1,103 @@
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <sycl/sycl.hpp>
+
+#include "devices.h"
+#include "quadrature.h"
+
+// grain sizes 1, factor, factor^2, ... up to max_grain_size (which is included as well)
+std::vector<size_t> geometric_candidates(size_t max_grain_size, size_t factor);
+
+// grain sizes between the neighbors of best in the geometric search (excluding best itself), at most max_grain_size
+std::vector<size_t> refinement_candidates(size_t best, size_t max_grain_size, size_t factor);
+
+// the tuning cache is a small tab-separated file with one line per device, total workload, and method
+std::optional<size_t> lookup_grain_size(const std::string & path, const std::string & device_name, size_t total_workload, const std::string & method_name);
+
+// replaces or adds the entry for device, total workload, and method; returns false if the file cannot be written
+bool store_grain_size(const std::string & path, const std::string & device_name, size_t total_workload, const std::string & method_name, size_t grain_size);
+
+// seconds per inner interval for one candidate grain size (best of several repetitions)
+// the probe launches min(n / g, max_outer) work items, as wide as the real run up to max_outer, so that every
+// candidate fills the device like the real run; to keep the probe short for large n, each work item integrates
+// only the first min(g, budget / width) of its g inner intervals (at least one)
+template <class F, class Rule> double probe_grain_size(
+    sycl::queue & q,
+    const F & f,
+    const Rule & rule,
+    const double x_min,
+    const double x_max,
+    const size_t total_workload,
+    const size_t grain_size,
+    const size_t max_outer,
+    const size_t budget
+) {
+    constexpr auto REPETITIONS{3};
+    const auto number_of_outer{total_workload / grain_size};
+    const auto dx{(x_max - x_min) / number_of_outer};
+    const auto dx_inner{dx / grain_size};
+    const auto count{std::min(number_of_outer, max_outer)};
+    const auto inner{std::clamp<size_t>(budget / count, 1, grain_size)};
+    const auto outer_at{[=](const size_t i) {
+        return rule(f, inner, x_min + i * dx, dx_inner, i == 0, i + 1 == number_of_outer);
+    }};
+    auto best{std::numeric_limits<double>::max()};
+    for (auto r{0}; r < REPETITIONS; r++) {
+        const auto start{std::chrono::steady_clock::now()};
+        sum_outer_on_queue(q, outer_at, 0, count);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best / (count * inner);
+}
+
+// geometric search over the grain size followed by a refinement around the fastest candidate
+// grain sizes stop where n / g would no longer fill the device
+template <class F, class Rule> size_t autotune_grain_size(
+    sycl::queue & q,
+    const F & f,
+    const Rule & rule,
+    const double x_min,
+    const double x_max,
+    const size_t total_workload
+) {
+    constexpr size_t FACTOR{4};
+    constexpr size_t OVERSUBSCRIPTION{4};
+    constexpr size_t BUDGET{1UL << 26}; // inner intervals per probe (spread over the full launch width)
+    const auto device{q.get_device()};
+    const size_t parallelism{device.get_info<sycl::info::device::max_compute_units>()
+        * device.get_info<sycl::info::device::max_work_group_size>()};
+    const auto max_outer{OVERSUBSCRIPTION * parallelism};
+    const auto max_grain_size{std::max<size_t>(1, total_workload / parallelism)};
+
+    // the first kernel launch includes just-in-time compilation (a single inner interval suffices)
+    probe_grain_size(q, f, rule, x_min, x_max, total_workload, 1, 1, 1);
+
+    auto best_grain_size{max_grain_size};
+    auto best_time{std::numeric_limits<double>::max()};
+    const auto probe{[&](const size_t grain_size) {
+        const auto time{probe_grain_size(q, f, rule, x_min, x_max, total_workload, grain_size, max_outer, BUDGET)};
+        spdlog::info("autotuning: grain size {} takes {} ns per inner interval", grain_size, 1e9 * time);
+        if (time < best_time) {
+            best_time = time;
+            best_grain_size = grain_size;
+        }
+    }};
+    for (const auto grain_size : geometric_candidates(max_grain_size, FACTOR)) {
+        probe(grain_size);
+    }
+    for (const auto grain_size : refinement_candidates(best_grain_size, max_grain_size, FACTOR)) {
+        probe(grain_size);
+    }
+    return best_grain_size;
+}
+
+#endif // AUTOTUNE_H_
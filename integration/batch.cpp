@@ -0,0 +1,83 @@
+#include "batch.h"
+
+#include <sstream>
+#include <stdexcept>
+
+std::vector<batch_job> read_batch_jobs(std::istream & in) {
+    std::vector<batch_job> jobs;
+    std::string line;
+    auto line_number{0UL};
+    while (std::getline(in, line)) {
+        line_number++;
+        const auto start{line.find_first_not_of(" \t\r")};
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        const auto fail{[&](const std::string & message) {
+            throw std::invalid_argument("line " + std::to_string(line_number) + ": " + message);
+        }};
+
+        std::istringstream fields{line};
+        batch_job job;
+        if (! (fields >> job.function_name >> job.x_min >> job.x_max >> job.total_workload >> job.grain_size)) {
+            fail("expected function lower upper total-workload grain-size [coefficients...]");
+        }
+        std::vector<double> coefficients;
+        double c;
+        while (fields >> c) {
+            coefficients.push_back(c);
+        }
+        if (! fields.eof()) {
+            fail("invalid coefficient");
+        }
+        if (job.x_min > job.x_max) {
+            fail("invalid range");
+        }
+        if (job.grain_size == 0 || job.total_workload < job.grain_size) {
+            fail("total workload must be at least the grain size (>= 1)");
+        }
+        if (job.function_name == "polynomial" && coefficients.empty()) {
+            fail("polynomial function requires coefficients");
+        }
+        try {
+            job.f = make_integrand(job.function_name, coefficients);
+        } catch (const std::invalid_argument & e) {
+            fail(e.what());
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+std::vector<batch_task> make_batch_tasks(const std::vector<batch_job> & jobs) {
+    std::vector<batch_task> tasks;
+    auto first_outer{0UL};
+    for (const auto & job : jobs) {
+        batch_task task{};
+        task.kind = job.f.index();
+        if (const auto p{std::get_if<polynomial>(&job.f)}) {
+            task.p = *p;
+        }
+        task.number_of_outer = job.total_workload / job.grain_size;
+        task.grain_size = job.grain_size;
+        task.x_min = job.x_min;
+        task.dx = (job.x_max - job.x_min) / task.number_of_outer;
+        task.dx_inner = task.dx / job.grain_size;
+        task.first_outer = first_outer;
+        first_outer += task.number_of_outer;
+        tasks.push_back(task);
+    }
+    return tasks;
+}
+
+size_t batch_outer_count(const std::vector<batch_task> & tasks) {
+    return tasks.empty() ? 0 : tasks.back().first_outer + tasks.back().number_of_outer;
+}
+
+std::vector<size_t> batch_group_begin(const std::vector<batch_task> & tasks, const size_t group_size) {
+    std::vector<size_t> group_begin{0};
+    for (const auto & task : tasks) {
+        group_begin.push_back(group_begin.back() + (task.number_of_outer + group_size - 1) / group_size);
+    }
+    return group_begin;
+}
@@ -0,0 +1,140 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <algorithm>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <sycl/sycl.hpp>
+
+#include "f.h"
+#include "trapezoid.h"
+
+// one line of a batch file: function lower upper total-workload grain-size [coefficients...]
+struct batch_job {
+    std::string function_name;
+    integrand f;
+    double x_min;
+    double x_max;
+    size_t total_workload;
+    size_t grain_size;
+};
+
+// reads jobs until the end of the stream; empty lines and lines starting with # are skipped
+// throws std::invalid_argument (with the line number) for malformed or invalid jobs
+std::vector<batch_job> read_batch_jobs(std::istream & in);
+
+// device-copyable form of a job (the integrand as the index of its alternative)
+struct batch_task {
+    size_t kind;
+    polynomial p;
+    double x_min;
+    double dx;
+    double dx_inner;
+    size_t grain_size;
+    size_t first_outer; // index of the job's first outer interval among all jobs
+    size_t number_of_outer;
+};
+
+std::vector<batch_task> make_batch_tasks(const std::vector<batch_job> & jobs);
+
+// total number of outer intervals of all jobs
+size_t batch_outer_count(const std::vector<batch_task> & tasks);
+
+// the i-th outer interval of a task with the given fixed rule
+template <class Rule> outer_result batch_outer_at(const Rule & rule, const batch_task & task, const size_t i) {
+    return visit_integrand(task.kind, task.p, [&](const auto & f) {
+        return rule(f, task.grain_size, task.x_min + i * task.dx, task.dx_inner, i == 0, i + 1 == task.number_of_outer);
+    });
+}
+
+// first work-group of each task (and the total number of work-groups at the end)
+// when every work-group of group_size work items belongs to a single task
+std::vector<size_t> batch_group_begin(const std::vector<batch_task> & tasks, size_t group_size);
+
+// index of the task that owns work-group g (binary search, skipping tasks without work-groups)
+template <class GroupBegin> size_t batch_task_of_group(const GroupBegin & group_begin, const size_t number_of_tasks, const size_t g) {
+    size_t low{0};
+    size_t high{number_of_tasks};
+    while (high - low > 1) {
+        const auto middle{low + (high - low) / 2};
+        if (group_begin[middle] <= g) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// all outer intervals of all jobs in a single nd_range kernel, one outer interval per work item
+// every work-group belongs to one job, adds its areas as a tree in local memory, and writes one partial sum;
+// a second kernel adds the partial sums of each job in order (no atomics, so results are reproducible)
+// results must be zero-initialized and have one element per task
+template <class Rule> void integrate_batch(sycl::queue & q, const Rule & rule, const std::vector<batch_task> & tasks, std::vector<double> & results) {
+    const auto number_of_tasks{tasks.size()};
+    if (batch_outer_count(tasks) == 0) {
+        return;
+    }
+    // a power of two, so that every level of the tree halves the work-group
+    const auto max_group_size{std::min<size_t>(256, q.get_device().get_info<sycl::info::device::max_work_group_size>())};
+    size_t group_size{1};
+    while (2 * group_size <= max_group_size) {
+        group_size *= 2;
+    }
+    const auto group_begin{batch_group_begin(tasks, group_size)};
+    const auto number_of_groups{group_begin.back()};
+
+    // end of scope copies the results back into the host vector
+    sycl::buffer<batch_task> t_buf{tasks.data(), sycl::range<1>{number_of_tasks}};
+    sycl::buffer<size_t> g_buf{group_begin.data(), sycl::range<1>{group_begin.size()}};
+    sycl::buffer<double> p_buf{sycl::range<1>{number_of_groups}};
+    sycl::buffer<double> r_buf{results.data(), sycl::range<1>{number_of_tasks}};
+    q.submit([&](auto & h) {
+        const sycl::accessor t{t_buf, h, sycl::read_only};
+        const sycl::accessor g{g_buf, h, sycl::read_only};
+        const sycl::accessor p{p_buf, h, sycl::write_only, sycl::no_init};
+        sycl::local_accessor<double> s{sycl::range<1>{group_size}, h};
+        h.parallel_for(sycl::nd_range<1>{number_of_groups * group_size, group_size}, [=](const auto & item) {
+            const size_t group{item.get_group_linear_id()};
+            const size_t l{item.get_local_id(0)};
+            const auto j{batch_task_of_group(g, number_of_tasks, group)};
+            const auto i{(group - g[j]) * group_size + l};
+            s[l] = i < t[j].number_of_outer ? batch_outer_at(rule, t[j], i).area : 0.0;
+            for (auto stride{group_size / 2}; stride > 0; stride /= 2) {
+                sycl::group_barrier(item.get_group());
+                if (l < stride) {
+                    s[l] += s[l + stride];
+                }
+            }
+            if (l == 0) {
+                p[group] = s[0];
+            }
+        });
+    }); // end of command group
+    q.submit([&](auto & h) {
+        const sycl::accessor g{g_buf, h, sycl::read_only};
+        const sycl::accessor p{p_buf, h, sycl::read_only};
+        const sycl::accessor r{r_buf, h, sycl::read_write};
+        h.parallel_for(sycl::range<1>{number_of_tasks}, [=](const auto & index) {
+            const size_t j{index};
+            auto sum{0.0};
+            for (auto group{g[j]}; group < g[j + 1]; group++) {
+                sum += p[group];
+            }
+            r[j] += sum;
+        });
+    }); // end of command group
+}
+
+// sequential counterpart of integrate_batch
+template <class Rule> void integrate_batch_sequentially(const Rule & rule, const std::vector<batch_task> & tasks, std::vector<double> & results) {
+    for (auto j{0UL}; j < tasks.size(); j++) {
+        for (auto i{0UL}; i < tasks[j].number_of_outer; i++) {
+            results[j] += batch_outer_at(rule, tasks[j], i).area;
+        }
+    }
+}
+
+#endif // BATCH_H_
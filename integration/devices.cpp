@@ -0,0 +1,66 @@
+#include "devices.h"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<sycl::device> select_devices(const std::string & selection) {
+    const auto available{sycl::device::get_devices()};
+    if (selection == "all") {
+        return available;
+    }
+    std::vector<sycl::device> selected;
+    std::istringstream indices{selection};
+    std::string index;
+    while (std::getline(indices, index, ',')) {
+        size_t position{0};
+        size_t i{0};
+        try {
+            i = std::stoul(index, &position);
+        } catch (const std::logic_error &) {
+            throw std::invalid_argument("invalid device index: " + index);
+        }
+        if (position != index.size() || i >= available.size()) {
+            throw std::invalid_argument("invalid device index: " + index);
+        }
+        selected.push_back(available[i]);
+    }
+    if (selected.empty()) {
+        throw std::invalid_argument("no devices selected");
+    }
+    return selected;
+}
+
+std::vector<double> compute_unit_weights(const std::vector<sycl::device> & devices) {
+    std::vector<double> weights;
+    for (const auto & device : devices) {
+        weights.push_back(device.get_info<sycl::info::device::max_compute_units>());
+    }
+    return weights;
+}
+
+std::vector<size_t> partition_outer(const size_t number_of_outer, const std::vector<double> & weights) {
+    std::vector<size_t> counts(weights.size(), 0);
+    if (weights.empty()) {
+        return counts;
+    }
+    const auto total_weight{std::accumulate(weights.begin(), weights.end(), 0.0)};
+    // guaranteed minimum share so that slow devices still take part (if possible)
+    const auto minimum{number_of_outer >= weights.size() ? 1UL : 0UL};
+    const auto distributable{number_of_outer - minimum * weights.size()};
+    // chunk boundaries from the cumulative weights, so that the counts always add up exactly
+    auto cumulative_weight{0.0};
+    auto previous_boundary{0UL};
+    for (auto d{0UL}; d < weights.size(); d++) {
+        cumulative_weight += weights[d];
+        auto boundary{distributable};
+        if (d + 1 < weights.size()) {
+            const auto share{total_weight > 0 ? cumulative_weight / total_weight : (d + 1.0) / weights.size()};
+            boundary = std::min(distributable, static_cast<size_t>(share * distributable));
+        }
+        counts[d] = minimum + boundary - previous_boundary;
+        previous_boundary = boundary;
+    }
+    return counts;
+}
@@ -0,0 +1,147 @@
+#ifndef DEVICES_H_
+#define DEVICES_H_
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <sycl/sycl.hpp>
+
+#include "summation.h"
+#include "timestamps.h"
+
+// devices selected by --devices: "all" or a comma-separated list of indices into sycl::device::get_devices()
+// throws std::invalid_argument for malformed or out-of-range indices
+std::vector<sycl::device> select_devices(const std::string & selection);
+
+// default chunk weights: the number of compute units of each device
+std::vector<double> compute_unit_weights(const std::vector<sycl::device> & devices);
+
+// splits the outer intervals into consecutive chunks proportional to the weights
+// every chunk gets at least one outer interval as long as there are enough of them
+std::vector<size_t> partition_outer(size_t number_of_outer, const std::vector<double> & weights);
+
+// reduces the areas outer_at(begin + i) for i in [0, count) on the given queue (one fused kernel)
+// Partial is double (with sycl::plus) or compensated (with compensated_plus)
+template <class Partial, class Combiner, class OuterAt> Partial reduce_outer_on_queue(
+    sycl::queue & q,
+    const OuterAt & outer_at,
+    const size_t begin,
+    const size_t count,
+    const Partial identity,
+    const Combiner combiner
+) {
+    if (count == 0) {
+        return identity;
+    }
+    sycl::buffer<Partial> r_buf{sycl::range<1>{1}};
+    q.submit([&](auto & h) {
+        const auto sum_reduction{sycl::reduction(r_buf, h, identity, combiner, {sycl::property::reduction::initialize_to_identity{}})};
+        h.parallel_for(sycl::range<1>{count}, sum_reduction, [=](const auto & index, auto & sum) {
+            sum.combine(Partial{outer_at(begin + index).area});
+        });
+    }); // end of command group
+    const sycl::host_accessor result{r_buf};
+    return result[0];
+}
+
+// pairwise summation of the areas outer_at(begin + i) for i in [0, count) on the given queue:
+// one outer interval per work item, a balanced tree per work-group in local memory,
+// and the partial sums of the work-groups added pairwise on the host
+// (a range reduction gives no such guarantee, as it may add many areas sequentially in one work item)
+template <class OuterAt> double sum_outer_pairwise_on_queue(sycl::queue & q, const OuterAt & outer_at, const size_t begin, const size_t count) {
+    if (count == 0) {
+        return 0.0;
+    }
+    // a power of two, so that every level of the tree halves the work-group
+    const auto max_group_size{std::min<size_t>(256, q.get_device().get_info<sycl::info::device::max_work_group_size>())};
+    size_t group_size{1};
+    while (2 * group_size <= max_group_size) {
+        group_size *= 2;
+    }
+    const auto number_of_groups{(count + group_size - 1) / group_size};
+    sycl::buffer<double> p_buf{sycl::range<1>{number_of_groups}};
+    q.submit([&](auto & h) {
+        const sycl::accessor p{p_buf, h, sycl::write_only, sycl::no_init};
+        sycl::local_accessor<double> s{sycl::range<1>{group_size}, h};
+        h.parallel_for(sycl::nd_range<1>{number_of_groups * group_size, group_size}, [=](const auto & item) {
+            const size_t i{item.get_global_id(0)};
+            const size_t l{item.get_local_id(0)};
+            s[l] = i < count ? outer_at(begin + i).area : 0.0;
+            for (auto stride{group_size / 2}; stride > 0; stride /= 2) {
+                sycl::group_barrier(item.get_group());
+                if (l < stride) {
+                    s[l] += s[l + stride];
+                }
+            }
+            if (l == 0) {
+                p[item.get_group_linear_id()] = s[0];
+            }
+        });
+    }); // end of command group
+    const sycl::host_accessor partials{p_buf};
+    accumulator result{summation::pairwise};
+    for (auto g{0UL}; g < number_of_groups; g++) {
+        result.add(partials[g]);
+    }
+    return result.value();
+}
+
+// kahan uses a compensated combiner and pairwise its own work-group tree, naive the built-in reduction
+template <class OuterAt> double sum_outer_on_queue(sycl::queue & q, const OuterAt & outer_at, const size_t begin, const size_t count, const summation mode = summation::naive) {
+    if (mode == summation::kahan) {
+        return reduce_outer_on_queue(q, outer_at, begin, count, COMPENSATED_ZERO, compensated_plus{}).value();
+    }
+    if (mode == summation::pairwise) {
+        return sum_outer_pairwise_on_queue(q, outer_at, begin, count);
+    }
+    return reduce_outer_on_queue(q, outer_at, begin, count, 0.0, sycl::plus<double>{});
+}
+
+// short probe run on each device, returning weights proportional to the measured throughput
+// the first run of each probe is discarded because it includes the kernel's just-in-time compilation
+template <class OuterAt> std::vector<double> calibrate_weights(std::vector<sycl::queue> & queues, const OuterAt & outer_at, const size_t probe_count) {
+    std::vector<double> weights;
+    for (auto & q : queues) {
+        sum_outer_on_queue(q, outer_at, 0, probe_count);
+        const auto start{std::chrono::steady_clock::now()};
+        sum_outer_on_queue(q, outer_at, 0, probe_count);
+        const auto seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+        weights.push_back(probe_count / std::max(seconds, 1e-9));
+    }
+    return weights;
+}
+
+// integrates the chunks concurrently (one host thread waiting for each queue)
+// and adds one row per device to device_timestamps
+template <class OuterAt> double sum_outer_on_devices(
+    std::vector<sycl::queue> & queues,
+    const std::vector<size_t> & counts,
+    const OuterAt & outer_at,
+    const summation mode,
+    device_ts_vector & device_timestamps
+) {
+    std::vector<std::future<double>> partial_sums;
+    std::vector<std::chrono::steady_clock::time_point> stops(queues.size());
+    const auto start{std::chrono::steady_clock::now()};
+    auto begin{0UL};
+    for (auto d{0UL}; d < queues.size(); d++) {
+        partial_sums.push_back(std::async(std::launch::async, [&, d, begin] {
+            const auto sum{sum_outer_on_queue(queues[d], outer_at, begin, counts[d], mode)};
+            stops[d] = std::chrono::steady_clock::now();
+            return sum;
+        }));
+        begin += counts[d];
+    }
+    accumulator result{mode};
+    for (auto d{0UL}; d < queues.size(); d++) {
+        result.add(partial_sums[d].get());
+        const auto name{queues[d].get_device().template get_info<sycl::info::device::name>()};
+        device_timestamps.push_back(device_timestamp{name, "Integration", start, stops[d]});
+    }
+    return result.value();
+}
+
+#endif // DEVICES_H_
@@ -1,9 +1,32 @@
 #include "f.h"
 
-#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
 
 // {{UnoAPI:f-implementation:begin}}
-double f(const double x) {
-    return 3 * pow(x, 2);
+const std::vector<std::string> & integrand_names() {
+    static const std::vector<std::string> names{"quadratic", "polynomial", "sin", "exp", "gaussian"};
+    return names;
+}
+
+integrand make_integrand(const std::string & name, const std::vector<double> & coefficients) {
+    if (name == "quadratic") {
+        return quadratic{};
+    } else if (name == "polynomial") {
+        if (coefficients.size() > polynomial::MAX_COEFFICIENTS) {
+            throw std::invalid_argument("at most " + std::to_string(polynomial::MAX_COEFFICIENTS) + " polynomial coefficients are supported");
+        }
+        polynomial p;
+        std::copy(coefficients.begin(), coefficients.end(), p.coefficients);
+        p.count = coefficients.size();
+        return p;
+    } else if (name == "sin") {
+        return sine{};
+    } else if (name == "exp") {
+        return exponential{};
+    } else if (name == "gaussian") {
+        return gaussian{};
+    }
+    throw std::invalid_argument("unknown integrand: " + name);
 }
 // {{UnoAPI:f-implementation:end}}
@@ -1,10 +1,91 @@
 #ifndef F_H_
 #define F_H_
 
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
 // {{UnoAPI:f-interface:begin}}
 #include <sycl/sycl.hpp>
 
-SYCL_EXTERNAL double f(double x);
+// integrands are function objects (not separately compiled functions)
+// so that the compiler can inline them into the integration kernels
+
+// f(x) = 3x^2
+struct quadratic {
+    double operator()(const double x) const {
+        return 3 * x * x;
+    }
+};
+
+// f(x) = c[0] + c[1] x + c[2] x^2 + ... with user-supplied coefficients
+struct polynomial {
+    static constexpr size_t MAX_COEFFICIENTS{16};
+    double coefficients[MAX_COEFFICIENTS]{};
+    size_t count{0};
+
+    double operator()(const double x) const {
+        // Horner's scheme
+        auto y{0.0};
+        for (auto i{count}; i > 0; i--) {
+            y = y * x + coefficients[i - 1];
+        }
+        return y;
+    }
+};
+
+// f(x) = sin(x)
+struct sine {
+    double operator()(const double x) const {
+        return sycl::sin(x);
+    }
+};
+
+// f(x) = e^x
+struct exponential {
+    double operator()(const double x) const {
+        return sycl::exp(x);
+    }
+};
+
+// f(x) = e^(-x^2 / 2) / sqrt(2 pi), the standard normal density
+struct gaussian {
+    static constexpr double INV_SQRT_2PI{0.3989422804014327};
+
+    double operator()(const double x) const {
+        return INV_SQRT_2PI * sycl::exp(-0.5 * x * x);
+    }
+};
+
+// one precompiled specialization of every kernel exists for each alternative
+using integrand = std::variant<quadratic, polynomial, sine, exponential, gaussian>;
 // {{UnoAPI:f-interface:end}}
 
+// like std::visit, but also usable in device code, where the integrand is known only at runtime
+// (e.g., batch jobs with different integrands in one kernel): selects alternative kind of integrand,
+// with p as the state of a polynomial (all other integrands are stateless)
+template <size_t K = 0, class Visitor> auto visit_integrand(const size_t kind, const polynomial & p, const Visitor & visitor) {
+    using F = std::variant_alternative_t<K, integrand>;
+    const auto call{[&] {
+        if constexpr (std::is_same_v<F, polynomial>) {
+            return visitor(p);
+        } else {
+            return visitor(F{});
+        }
+    }};
+    if constexpr (K + 1 == std::variant_size_v<integrand>) {
+        return call();
+    } else {
+        return kind == K ? call() : visit_integrand<K + 1>(kind, p, visitor);
+    }
+}
+
+// names accepted by make_integrand (the first one is the default)
+const std::vector<std::string> & integrand_names();
+
+// looks up an integrand by name; coefficients are used only by polynomial
+// throws std::invalid_argument for unknown names or too many coefficients
+integrand make_integrand(const std::string & name, const std::vector<double> & coefficients);
+
 #endif // F_H_
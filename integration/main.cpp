@@ -1,4 +1,11 @@
 #include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <variant>
 
 #include <CLI/CLI.hpp>
 #include <fmt/format.h>
@@ -9,33 +16,54 @@
 #include <dpc_common.hpp>
 
 #include "f.h"
-#include "trapezoid.h"
+#include "quadrature.h"
+#include "devices.h"
+#include "autotune.h"
+#include "batch.h"
+#include "simd.h"
+#include "threads.h"
+#include "summation.h"
 #include "timestamps.h"
-
-// {{UnoAPI:main-print-function-values:begin}}
-// function template to avoid code repetition (DRY)
-// works as long as the first argument has a size()
-// method and an indexing operator[]
-template <class Indexable> void print_function_values(const Indexable & values, const double x_min, const double dx, const uint x_precision, const uint y_precision) {
-    for (auto i{0UL}; i < values.size(); i++) {
-        fmt::print("{}: f({:.{}f}) = {:.{}f}\n", i, x_min + i * dx, x_precision, values[i], y_precision);
-    }
-}
-// {{UnoAPI:main-print-function-values:end}}
+#include "validate.h"
+#include "values.h"
 
 int main(const int argc, const char * const argv[]) {
     // {{UnoAPI:main-declarations:begin}}
     size_t total_workload{1000};
-    uint grain_size{100};
+    size_t grain_size{100};
     double x_min{0.0};
     double x_max{1.0};
     bool show_function_values{false};
-    bool run_sequentially{false};
+    std::string sequential_mode;
+    std::string backend{"sycl"};
+    size_t threads{std::max(1U, std::thread::hardware_concurrency())};
     bool run_cpuonly{false};
+    std::string device_selection;
+    bool list_devices{false};
+    std::string batch_file;
+    bool calibrate{false};
+    size_t probe_size{1000};
+    bool autotune{false};
+    std::string tuning_cache{"integration-tuning.tsv"};
+    std::string function_name{integrand_names().front()};
+    std::vector<double> coefficients;
+    std::string method_name{method_names().front()};
+    double tolerance{1e-10};
+    size_t max_intervals{10000000};
+    std::string summation_name{summation_names().front()};
+    bool validate{false};
+    size_t validation_samples{32};
+    double validation_tolerance{1e-9};
+    std::string values_format_name{values_format_names().front()};
+    std::string values_output{"-"};
+    size_t values_chunk_size{1 << 20};
     uint x_precision{1};
     uint y_precision{1};
     std::string perf_output;
     ts_vector timestamps;
+    counter_vector counters;
+    device_ts_vector device_timestamps;
+    size_t evaluations{0}; // calls of f (including validation and function values)
     std::string device_name;
     // {{UnoAPI:main-declarations:end}}
 
@@ -44,23 +72,137 @@ int main(const int argc, const char * const argv[]) {
     app.option_defaults()->always_capture_default(true);
     app.add_option("-l,--lower,--xmin", x_min, "x min value");
     app.add_option("-u,--upper,--xmax", x_max, "x max value");
+    app.add_option("-f,--function", function_name, "function to integrate")->check(CLI::IsMember(integrand_names()));
+    app.add_option("--coefficients", coefficients, "coefficients c0 c1 c2 ... of the polynomial function");
+    app.add_option("-m,--method", method_name, "integration method (adaptive starts from n / g intervals)")->check(CLI::IsMember(method_names()));
+    app.add_option("--tolerance", tolerance, "absolute error tolerance for the adaptive method")->check(CLI::PositiveNumber.description(" > 0"));
+    app.add_option("--max-intervals", max_intervals, "maximum number of intervals evaluated by the adaptive method")->check(CLI::PositiveNumber.description(" >= 1"));
+    const auto summation_option{app.add_option("--summation", summation_name, "how the areas of the outer intervals are added up")->check(CLI::IsMember(summation_names()))};
+    app.add_option("-b,--batch", batch_file, "file with one job per line (- for stdin): function lower upper total-workload grain-size [coefficients...]");
     app.add_option("-n,--total-workload", total_workload, "total workload (number of trapezoids)")->check(CLI::PositiveNumber.description(" >= 1"));
-    app.add_option("-g,--grain-size", grain_size, "number of inner (sequential) trapezoids (for each outer trapezoid)")->check(CLI::PositiveNumber.description(" >= 1"));
-    app.add_flag("-s,--sequential", run_sequentially);
+    const auto grain_size_option{app.add_option("-g,--grain-size", grain_size, "number of inner (sequential) trapezoids (for each outer trapezoid)")->check(CLI::PositiveNumber.description(" >= 1"))};
+    app.add_flag("--autotune", autotune, "probe grain sizes on the device, use the fastest, and remember it in the tuning cache");
+    app.add_option("--tuning-cache", tuning_cache, "file with the autotuned grain size for each device, total workload, and method (used when -g is not given)");
+    add_sequential_flag(app, sequential_mode);
+    app.add_option("--backend", backend, "where the parallel (not sequential) integration runs: sycl or threads (host threads without SYCL)")->check(CLI::IsMember(std::vector<std::string>{"sycl", "threads"}));
+    app.add_option("-t,--threads", threads, "number of host threads for --backend threads")->check(CLI::PositiveNumber.description(" >= 1"));
     app.add_flag("-c,--cpu-only", run_cpuonly);
-    app.add_flag("-v,--show-function-values", show_function_values);
+    app.add_option("-d,--devices", device_selection, "split the work across devices: all or comma-separated indices (see --list-devices)");
+    app.add_flag("--list-devices", list_devices, "show the indices of the available devices and exit");
+    app.add_flag("--calibrate", calibrate, "weight the devices by a short probe run instead of their compute units");
+    app.add_option("--probe-size", probe_size, "number of outer intervals for each calibration probe")->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_flag("-v,--show-function-values", show_function_values, "write f on the n / g + 1 points of the outer grid (on a device, f is evaluated there again in chunks; the extra calls are part of the function evaluations)");
+    app.add_flag("--validate", validate, "recheck a sample of outer trapezoids sequentially on the host");
+    app.add_option("--validation-samples", validation_samples, "number of outer trapezoids to recheck")->check(CLI::PositiveNumber.description(" >= 1"));
+    app.add_option("--validation-tolerance", validation_tolerance, "relative tolerance for rechecked trapezoids")->check(CLI::PositiveNumber.description(" > 0"));
+    app.add_option("--values-format", values_format_name, "format of the function values: text or binary (little-endian doubles)")->check(CLI::IsMember(values_format_names()));
+    app.add_option("--values-output", values_output, "file for the function values (- for stdout)");
+    app.add_option("--values-chunk-size", values_chunk_size, "number of function values computed on the device per chunk")->check(CLI::PositiveNumber.description(" >= 1"));
     app.add_option("-x,--x-format-precision", x_precision, "decimal precision for x values")->check(CLI::PositiveNumber.description(" >= 1"));
     app.add_option("-y,--y-format-precision", y_precision, "decimal precision for y (function) values")->check(CLI::PositiveNumber.description(" >= 1"));
     app.add_option("-p,--perfdata-output-file", perf_output, "output file for performance data");
 
     CLI11_PARSE(app, argc, argv);
     // {{UnoAPI:main-cli-setup-and-parse:end}}
+    const auto run_sequentially{! sequential_mode.empty()};
+    const auto run_on_threads{! run_sequentially && backend == "threads"};
+
+    if (list_devices) {
+        const auto available{sycl::device::get_devices()};
+        for (auto i{0UL}; i < available.size(); i++) {
+            fmt::print("{}: {}\n", i, available[i].get_info<sycl::info::device::name>());
+        }
+        return 0;
+    }
+
+    if (! batch_file.empty() && method_name == "adaptive") {
+        spdlog::error("batch mode supports only the fixed rules");
+        return 1;
+    }
+
+    std::vector<sycl::device> devices;
+    if (! device_selection.empty()) {
+        try {
+            devices = select_devices(device_selection);
+        } catch (const std::invalid_argument & e) {
+            spdlog::error("{}", e.what());
+            return 1;
+        }
+        if (method_name == "adaptive" || run_sequentially || run_on_threads || ! batch_file.empty()) {
+            spdlog::warn("--devices only applies to the fixed rules on devices");
+        }
+    }
+
+    if (run_sequentially && backend != "sycl") {
+        spdlog::warn("--sequential overrides --backend {}", backend);
+    }
+
+    if (run_on_threads && ! batch_file.empty()) {
+        spdlog::warn("batch mode does not support --backend threads, using sycl");
+    }
+
+    if (summation_option->count() > 0 && (method_name == "adaptive" || ! batch_file.empty())) {
+        spdlog::warn("--summation only applies to the fixed rules outside of batch mode");
+    }
+
+    if (sequential_mode == "simd" && (method_name == "adaptive" || ! batch_file.empty())) {
+        spdlog::warn("--sequential=simd only applies to the fixed rules, running scalar");
+    }
 
     if (x_min > x_max) {
         spdlog::error("invalid range: [{}, {}]", x_min, x_max);
         return 1;
     }
 
+    if (function_name == "polynomial" && coefficients.empty()) {
+        spdlog::error("polynomial function requires --coefficients");
+        return 1;
+    }
+
+    if (function_name != "polynomial" && ! coefficients.empty()) {
+        spdlog::warn("--coefficients only applies to the polynomial function");
+    }
+
+    integrand selected_integrand;
+    try {
+        selected_integrand = make_integrand(function_name, coefficients);
+    } catch (const std::invalid_argument & e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    const auto summation_mode{make_summation(summation_name)};
+
+    // an explicit -g wins; otherwise the grain size comes from autotuning now or from an earlier autotuning run
+    const auto tunable{batch_file.empty() && method_name != "adaptive" && ! run_sequentially && ! run_on_threads && devices.empty()};
+    if (autotune && ! tunable) {
+        spdlog::warn("--autotune only applies to the fixed rules on a single device");
+    }
+    if (tunable && (autotune || grain_size_option->count() == 0)) {
+        const sycl::device device{run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v};
+        const auto name{device.get_info<sycl::info::device::name>()};
+        if (autotune) {
+            if (grain_size_option->count() > 0) {
+                spdlog::warn("--autotune overrides --grain-size {}", grain_size);
+            }
+            sycl::queue q{device, dpc_common::exception_handler};
+            grain_size = std::visit([&](const auto & f, const auto & rule) {
+                return autotune_grain_size(q, f, rule, x_min, x_max, total_workload);
+            }, selected_integrand, make_rule(method_name));
+            spdlog::info("autotuned grain size {} for {} with total workload {}", grain_size, name, total_workload);
+            if (! store_grain_size(tuning_cache, name, total_workload, method_name, grain_size)) {
+                spdlog::warn("cannot write tuning cache {}", tuning_cache);
+            }
+        } else if (const auto cached{lookup_grain_size(tuning_cache, name, total_workload, method_name)}) {
+            grain_size = *cached;
+            spdlog::info("using autotuned grain size {} from {}", grain_size, tuning_cache);
+        }
+    }
+
+    if (total_workload < grain_size) {
+        spdlog::error("total workload {} is smaller than grain size {}", total_workload, grain_size);
+        return 1;
+    }
+
     if (total_workload % grain_size != 0) {
         spdlog::warn("total workload {} is not a multiple of grain size {}", total_workload, grain_size);
     }
@@ -71,123 +213,399 @@ int main(const int argc, const char * const argv[]) {
     const auto dx{(x_max - x_min) / number_of_trapezoids};
     const auto half_dx{0.5 * dx}; // precomputed for area calculation
     const auto dx_inner{dx / grain_size};
-    const auto half_dx_inner{0.5 * dx_inner};
     // {{UnoAPI:main-domain-setup:end}}
 
-    spdlog::info("integrating function from {} to {} using {} trapezoid(s) with grain size {}, dx = {}", x_min, x_max, total_workload, grain_size, dx);
+    auto validation_failed{false};
+
+    // function values go through a buffered writer, so that devices can stream them in chunks
+    const auto values_fmt{make_values_format(values_format_name)};
+    if (show_function_values && values_fmt == values_format::binary && values_output == "-") {
+        spdlog::error("binary function values require --values-output");
+        return 1;
+    }
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> values_file{nullptr, &std::fclose};
+    if (show_function_values && values_output != "-") {
+        values_file.reset(std::fopen(values_output.c_str(), "wb"));
+        if (! values_file) {
+            spdlog::error("cannot open values output file: {}", values_output);
+            return 1;
+        }
+    }
+    value_writer writer{values_file ? values_file.get() : stdout, values_fmt, x_min, dx, x_precision, y_precision};
+
+    if (batch_file.empty()) {
+        spdlog::info("integrating {} from {} to {} with {} method using {} interval(s) with grain size {}, dx = {}", function_name, x_min, x_max, method_name, total_workload, grain_size, dx);
+    }
     mark_time(timestamps, "Start");
 
-    // {{UnoAPI:main-sequential-option:begin}}
-    if (run_sequentially) {
-        device_name = "sequential";
-        std::vector values(size, 0.0);
-        auto result{0.0};
-
-        mark_time(timestamps,"Memory allocation");
-        spdlog::info("starting sequential integration");
-
-        // populate vector with function values and add trapezoid area to result
-        // the inner loop performs a finer-grained calculation
-        values[0] += f(x_min);
-        for (auto i{0UL}; i < number_of_trapezoids; i++) {
-            const auto x_pos{x_min + i * dx};
-            result += outer_trapezoid(grain_size, x_pos, dx_inner, half_dx_inner);
-            values[i + 1] = f(x_pos);
+    // many jobs on one queue: the outer intervals of all jobs form a single kernel launch
+    // and every job gets one output line: function lower upper total-workload grain-size result
+    if (! batch_file.empty()) {
+        std::vector<batch_job> jobs;
+        try {
+            if (batch_file == "-") {
+                jobs = read_batch_jobs(std::cin);
+            } else {
+                std::ifstream input{batch_file};
+                if (! input.is_open()) {
+                    spdlog::error("cannot open batch file: {}", batch_file);
+                    return 1;
+                }
+                jobs = read_batch_jobs(input);
+            }
+        } catch (const std::invalid_argument & e) {
+            spdlog::error("{}: {}", batch_file, e.what());
+            return 1;
         }
+        mark_time(timestamps, "Reading jobs");
 
+        const auto tasks{make_batch_tasks(jobs)};
+        std::vector<double> results(tasks.size(), 0.0);
+        spdlog::info("integrating {} job(s) with {} outer interval(s) in total using {} method", tasks.size(), batch_outer_count(tasks), method_name);
+
+        std::visit([&](const auto & rule) {
+            for (const auto & task : tasks) {
+                evaluations += total_evaluations(rule, task.number_of_outer, task.grain_size);
+            }
+            if (run_sequentially) {
+                device_name = "sequential";
+                integrate_batch_sequentially(rule, tasks, results);
+            } else {
+                sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+                sycl::queue q{device, dpc_common::exception_handler};
+                mark_time(timestamps,"Queue creation");
+                device_name = q.get_device().get_info<sycl::info::device::name>();
+                spdlog::info("Device: {}", device_name);
+                integrate_batch(q, rule, tasks, results);
+            }
+        }, make_rule(method_name));
         mark_time(timestamps, "Integration");
-        spdlog::info("result should be available now");
-        fmt::print("result = {}\n", result);
 
-        if (show_function_values) {
-            spdlog::info("showing function values");
-            print_function_values(values, x_min, dx, x_precision, y_precision);
-            mark_time(timestamps, "Output");
+        for (auto j{0UL}; j < jobs.size(); j++) {
+            const auto & job{jobs[j]};
+            fmt::print("{} {} {} {} {} {}\n", job.function_name, job.x_min, job.x_max, job.total_workload, job.grain_size, results[j]);
         }
+        mark_time(timestamps, "Output");
     }
-    // {{UnoAPI:main-sequential-option:end}}
-    
-    else {
-        // important: buffer NOT explicitly backed by host-allocated vector
-        // this allows the data to live on the device until accessed on the host (if desired)
-        // {{UnoAPI:main-parallel-buffers:begin}}
-        sycl::buffer<double> v_buf{sycl::range<1>{size}};
-        sycl::buffer<double> t_buf{sycl::range<1>{number_of_trapezoids}};
-        sycl::buffer<double> r_buf{sycl::range<1>{1}};
-        // {{UnoAPI:main-parallel-buffers:end}}
-
-        mark_time(timestamps,"Memory allocation");
-        spdlog::info("preparing for vectorized integration");
-
-        // {{UnoAPI:main-parallel-devices:begin}}
-        sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
-        // {{UnoAPI:main-parallel-devices:end}}
-
-        // we allow the queue to figure out the correct ordering of the three tasks
-        // {{UnoAPI:main-parallel-queue:begin}}
-        sycl::queue q{device, dpc_common::exception_handler};
-        mark_time(timestamps,"Queue creation");
-        device_name = q.get_device().get_info<sycl::info::device::name>();
-        spdlog::info("Device: {}", device_name);
-        // {{UnoAPI:main-parallel-queue:end}}
-
-        // populate buffer with function values
-        // {{UnoAPI:main-parallel-submit-parallel-for-values:begin}}
-        q.submit([&](auto & h) {
-            const sycl::accessor v{v_buf, h};
-            h.parallel_for(size, [=](const auto & index) {
-                v[index] = f(x_min + index * dx);
-            });
-        }); // end of command group
-        // {{UnoAPI:main-parallel-submit-parallel-for-values:end}}
-
-        // populate buffer with trapezoid values
-        // the inner, sequential loop performs a finer-grained calculation
-        // {{UnoAPI:main-parallel-submit-parallel-for-trapezoids:begin}}
-        q.submit([&](auto & h) {
-            const sycl::accessor t{t_buf, h};
-            h.parallel_for(size, [=](const auto & index) {
-                t[index] = outer_trapezoid(grain_size, x_min + index * dx, dx_inner, half_dx_inner);
-            });
-        }); // end of command group
-        // {{UnoAPI:main-parallel-submit-parallel-for-trapezoids:end}}
-
-        // perform reduction into result
-        // {{UnoAPI:main-parallel-submit-reduce:begin}}
-        q.submit([&](auto & h) {
-            const sycl::accessor t{t_buf, h};
-            const auto sum_reduction{sycl::reduction(r_buf, h, sycl::plus<>())};
-            h.parallel_for(sycl::range<1>{number_of_trapezoids}, sum_reduction, [=](const auto & index, auto & sum) {
-                sum.combine(t[index]);
-            });
-        }); // end of command group
-        // {{UnoAPI:main-parallel-submit-reduce:end}}
-
-        spdlog::info("done submitting to queue...waiting for results");
-
-        // {{UnoAPI:main-parallel-gather-on-host:begin}}
-        const sycl::host_accessor result{r_buf};
-        mark_time(timestamps,"Integration");
-        spdlog::info("result should be available now");
-        fmt::print("result = {}\n", result[0]);
-        // {{UnoAPI:main-parallel-gather-on-host:end}}
-
-        // {{UnoAPI:main-parallel-show-results-log:begin}}
-        if (show_function_values) {
-            spdlog::info("preparing function values");
-            const sycl::host_accessor values{v_buf};
-            mark_time(timestamps,"Host data access");
-            spdlog::info("showing function values");
-            print_function_values(values, x_min, dx, x_precision, y_precision);
-            mark_time(timestamps,"Output");
+
+    else if (method_name == "adaptive") {
+        if (show_function_values || validate) {
+            spdlog::warn("function values and validation are not available with the adaptive method");
         }
-        // {{UnoAPI:main-parallel-show-results-log:end}}
+
+        // refinement starts from the n / g outer intervals
+        // each round evaluates all intervals that still need bisection as one batch
+        std::visit([&](const auto & f) {
+            adaptive_result result;
+            if (run_sequentially) {
+                device_name = "sequential";
+                spdlog::info("starting sequential adaptive integration");
+                result = integrate_adaptive(x_min, x_max, tolerance, number_of_trapezoids, max_intervals, [&](const auto & active, auto & estimates) {
+                    for (auto i{0UL}; i < active.size(); i++) {
+                        estimates[i] = gauss_kronrod_15(f, active[i].a, active[i].b);
+                    }
+                });
+            } else if (run_on_threads) {
+                device_name = fmt::format("threads x{}", threads);
+                spdlog::info("starting adaptive integration on {} threads", threads);
+                result = integrate_adaptive(x_min, x_max, tolerance, number_of_trapezoids, max_intervals, [&](const auto & active, auto & estimates) {
+                    for_each_chunk(active.size(), threads, default_chunk_size(active.size(), threads), [&](const size_t begin, const size_t end) {
+                        for (auto i{begin}; i < end; i++) {
+                            estimates[i] = gauss_kronrod_15(f, active[i].a, active[i].b);
+                        }
+                    });
+                });
+            } else {
+                sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+                sycl::queue q{device, dpc_common::exception_handler};
+                mark_time(timestamps,"Queue creation");
+                device_name = q.get_device().get_info<sycl::info::device::name>();
+                spdlog::info("Device: {}", device_name);
+
+                result = integrate_adaptive(x_min, x_max, tolerance, number_of_trapezoids, max_intervals, [&](const auto & active, auto & estimates) {
+                    // end of scope copies the estimates back into the host vector
+                    sycl::buffer<interval> a_buf{active.data(), sycl::range<1>{active.size()}};
+                    sycl::buffer<estimate> e_buf{estimates.data(), sycl::range<1>{estimates.size()}};
+                    q.submit([&](auto & h) {
+                        const sycl::accessor a{a_buf, h, sycl::read_only};
+                        const sycl::accessor e{e_buf, h, sycl::write_only, sycl::no_init};
+                        h.parallel_for(sycl::range<1>{active.size()}, [=](const auto & index) {
+                            e[index] = gauss_kronrod_15(f, a[index].a, a[index].b);
+                        });
+                    }); // end of command group
+                });
+            }
+
+            mark_time(timestamps, "Integration");
+            evaluations = result.evaluations;
+            spdlog::info("{} interval(s) after {} round(s) using {} function evaluations, estimated error {}", result.intervals, result.rounds, result.evaluations, result.error);
+            if (! result.converged) {
+                spdlog::warn("tolerance {} not met within {} intervals", tolerance, max_intervals);
+            }
+            fmt::print("result = {}\n", result.integral);
+        }, selected_integrand);
+    }
+
+    else {
+        // the kernels below are instantiated once for each kind of integrand and fixed rule
+        // and the selected ones are dispatched here at runtime
+        std::visit([&](const auto & f, const auto & rule) {
+            using rule_type = std::decay_t<decltype(rule)>;
+
+            // single definition of the i-th outer interval shared by host, device, and validation
+            // each point of the grid is evaluated exactly once across all outer intervals (function values on a device excepted, see below)
+            const auto outer_at{[=](const size_t i) {
+                return rule(f, grain_size, x_min + i * dx, dx_inner, i == 0, i + 1 == number_of_trapezoids);
+            }};
+            evaluations = total_evaluations(rule, number_of_trapezoids, grain_size);
+
+            // on the host, function values on the outer grid come with the integration if the rule samples them anyway
+            // (devices stream them in chunks instead, so that they never take up memory for the whole grid)
+            const auto keep_values{show_function_values && rule_type::SAMPLES_OUTER_GRID};
+
+            // {{UnoAPI:main-sequential-option:begin}}
+            // the host backends share the output of the function values
+            if (run_sequentially || run_on_threads) {
+                device_name = "sequential";
+                std::vector values(show_function_values ? size : 0, 0.0);
+                accumulator result{summation_mode};
+
+                mark_time(timestamps,"Memory allocation");
+
+                if (run_on_threads) {
+                    device_name = fmt::format("threads x{}", threads);
+                    spdlog::info("starting integration on {} threads", threads);
+                    result.add(sum_outer_on_threads(outer_at, number_of_trapezoids, threads, summation_mode, keep_values ? values.data() : nullptr));
+                } else if (sequential_mode == "simd") {
+                    spdlog::info("starting sequential integration (simd)");
+                    device_name = fmt::format("sequential simd x{}", LANES);
+                    integrate_simd(f, rule, grain_size, x_min, dx, dx_inner, number_of_trapezoids, result, keep_values ? values.data() : nullptr);
+                } else {
+                    spdlog::info("starting sequential integration");
+                    // add area of each outer interval to result and keep function values (if requested)
+                    // the inner loop performs a finer-grained calculation
+                    for (auto i{0UL}; i < number_of_trapezoids; i++) {
+                        const auto outer{outer_at(i)};
+                        result.add(outer.area);
+                        if (keep_values) {
+                            values[i] = outer.y_left;
+                            if (i + 1 == number_of_trapezoids) {
+                                values[i + 1] = outer.y_right;
+                            }
+                        }
+                    }
+                }
+
+                mark_time(timestamps, "Integration");
+                spdlog::info("result should be available now");
+                fmt::print("result = {}\n", result.value());
+
+                if (show_function_values) {
+                    if (! keep_values) {
+                        for (auto i{0UL}; i < size; i++) {
+                            values[i] = f(x_min + i * dx);
+                        }
+                        evaluations += size;
+                    }
+                    spdlog::info("showing function values");
+                    writer.write(values, values.size());
+                    writer.flush();
+                    mark_time(timestamps, "Output");
+                }
+            }
+            // {{UnoAPI:main-sequential-option:end}}
+
+            // consecutive chunks of outer intervals run concurrently, one queue per device
+            else if (! devices.empty()) {
+                if (show_function_values || validate) {
+                    spdlog::warn("function values and validation are only available on a single device");
+                }
+
+                std::vector<sycl::queue> queues;
+                for (const auto & device : devices) {
+                    queues.emplace_back(device, dpc_common::exception_handler);
+                    spdlog::info("Device {}: {}", queues.size() - 1, device.get_info<sycl::info::device::name>());
+                }
+                mark_time(timestamps,"Queue creation");
+                device_name = fmt::format("{} devices", queues.size());
+
+                auto weights{compute_unit_weights(devices)};
+                if (calibrate) {
+                    const auto probe_count{std::min(probe_size, number_of_trapezoids)};
+                    spdlog::info("calibrating with {} outer interval(s) per device", probe_count);
+                    weights = calibrate_weights(queues, outer_at, probe_count);
+                    const auto probe_evaluations{probe_count == number_of_trapezoids
+                        ? total_evaluations(rule, probe_count, grain_size)
+                        : probe_count * rule_type::evaluations(grain_size, false)};
+                    evaluations += 2 * queues.size() * probe_evaluations;
+                    mark_time(timestamps,"Calibration");
+                }
+
+                const auto counts{partition_outer(number_of_trapezoids, weights)};
+                for (auto d{0UL}; d < counts.size(); d++) {
+                    spdlog::info("Device {} gets {} outer interval(s) with weight {}", d, counts[d], weights[d]);
+                }
+
+                spdlog::info("done submitting to queues...waiting for results");
+                const auto result{sum_outer_on_devices(queues, counts, outer_at, summation_mode, device_timestamps)};
+                mark_time(timestamps,"Integration");
+                spdlog::info("result should be available now");
+                fmt::print("result = {}\n", result);
+            }
+
+            else {
+                // important: buffers NOT explicitly backed by host-allocated vector
+                // this allows the data to live on the device until accessed on the host (if desired)
+                // the areas of the outer intervals go straight into the reduction,
+                // and the function values are streamed through two chunk-sized buffers (if requested)
+                // {{UnoAPI:main-parallel-buffers:begin}}
+                sycl::buffer<double> r_buf{sycl::range<1>{1}};
+                sycl::buffer<compensated> c_buf{sycl::range<1>{1}}; // instead of r_buf for kahan summation
+                const auto chunk_size{show_function_values ? std::min(values_chunk_size, size) : 1};
+                sycl::buffer<double> v_bufs[]{sycl::buffer<double>{sycl::range<1>{chunk_size}}, sycl::buffer<double>{sycl::range<1>{chunk_size}}};
+                // {{UnoAPI:main-parallel-buffers:end}}
+
+                mark_time(timestamps,"Memory allocation");
+                spdlog::info("preparing for vectorized integration");
+
+                // {{UnoAPI:main-parallel-devices:begin}}
+                sycl::device device { run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v };
+                // {{UnoAPI:main-parallel-devices:end}}
+
+                // we allow the queue to figure out the correct ordering of the tasks
+                // {{UnoAPI:main-parallel-queue:begin}}
+                sycl::queue q{device, dpc_common::exception_handler};
+                mark_time(timestamps,"Queue creation");
+                device_name = q.get_device().get_info<sycl::info::device::name>();
+                spdlog::info("Device: {}", device_name);
+                // {{UnoAPI:main-parallel-queue:end}}
+
+                // compute each outer interval and combine it into the result in a single kernel
+                // the inner, sequential loop performs a finer-grained calculation
+                // the reduction adds either doubles or compensated sums (for kahan summation);
+                // pairwise summation reduces each work-group as a tree in local memory instead (see devices.h)
+                // {{UnoAPI:main-parallel-submit-reduce:begin}}
+                const auto submit_integration{[&](auto & result_buf, const auto identity, const auto combiner) {
+                    using partial_type = std::remove_const_t<decltype(identity)>;
+                    q.submit([&](auto & h) {
+                        const auto sum_reduction{sycl::reduction(result_buf, h, identity, combiner, {sycl::property::reduction::initialize_to_identity{}})};
+                        h.parallel_for(sycl::range<1>{number_of_trapezoids}, sum_reduction, [=](const auto & index, auto & sum) {
+                            const size_t i{index};
+                            const auto outer{outer_at(i)};
+                            sum.combine(partial_type{outer.area});
+                        });
+                    }); // end of command group
+                }};
+                auto pairwise_result{0.0};
+                if (summation_mode == summation::kahan) {
+                    submit_integration(c_buf, COMPENSATED_ZERO, compensated_plus{});
+                } else if (summation_mode == summation::pairwise) {
+                    pairwise_result = sum_outer_pairwise_on_queue(q, outer_at, 0, number_of_trapezoids);
+                } else {
+                    submit_integration(r_buf, 0.0, sycl::plus<double>{});
+                }
+                // {{UnoAPI:main-parallel-submit-reduce:end}}
+
+                spdlog::info("done submitting to queue...waiting for results");
+
+                // {{UnoAPI:main-parallel-gather-on-host:begin}}
+                const auto result{summation_mode == summation::kahan ? sycl::host_accessor{c_buf}[0].value()
+                    : summation_mode == summation::pairwise ? pairwise_result : sycl::host_accessor{r_buf}[0]};
+                mark_time(timestamps,"Integration");
+                spdlog::info("result should be available now");
+                fmt::print("result = {}\n", result);
+                // {{UnoAPI:main-parallel-gather-on-host:end}}
+
+                // recompute a sample of outer trapezoids on the device and sequentially on the host
+                // so that tuning runs (e.g., sweeps over -g) cannot silently produce wrong numbers
+                if (validate) {
+                    const auto indices{validation_sample(number_of_trapezoids, validation_samples)};
+                    spdlog::info("validating {} sampled outer interval(s)", indices.size());
+                    sycl::buffer<size_t> i_buf{indices.data(), sycl::range<1>{indices.size()}};
+                    sycl::buffer<double> s_buf{sycl::range<1>{indices.size()}};
+
+                    q.submit([&](auto & h) {
+                        const sycl::accessor i{i_buf, h, sycl::read_only};
+                        const sycl::accessor s{s_buf, h, sycl::write_only, sycl::no_init};
+                        h.parallel_for(sycl::range<1>{indices.size()}, [=](const auto & index) {
+                            // bounds-checked: an out-of-range index yields NaN and fails the comparison
+                            s[index] = i[index] < number_of_trapezoids ? outer_at(i[index]).area : std::numeric_limits<double>::quiet_NaN();
+                        });
+                    }); // end of command group
+
+                    const sycl::host_accessor sampled{s_buf};
+                    auto mismatches{0UL};
+                    for (auto k{0UL}; k < indices.size(); k++) {
+                        const auto expected{outer_at(indices[k]).area};
+                        evaluations += 2 * rule_type::evaluations(grain_size, indices[k] + 1 == number_of_trapezoids);
+                        if (! nearly_equal(expected, sampled[k], validation_tolerance)) {
+                            spdlog::error("outer interval {} differs: device {} vs. sequential {}", indices[k], sampled[k], expected);
+                            mismatches++;
+                        }
+                    }
+
+                    // the outer trapezoids must cover exactly [x_min, x_max]
+                    const auto x_last{x_min + number_of_trapezoids * dx};
+                    if (! nearly_equal(x_max, x_last, validation_tolerance)) {
+                        spdlog::error("outer intervals end at {} instead of {}", x_last, x_max);
+                        mismatches++;
+                    }
+
+                    mark_time(timestamps,"Validation");
+                    if (mismatches > 0) {
+                        spdlog::error("validation failed with {} mismatch(es)", mismatches);
+                        validation_failed = true;
+                    } else {
+                        spdlog::info("validation passed");
+                    }
+                }
+
+                // {{UnoAPI:main-parallel-show-results-log:begin}}
+                if (show_function_values) {
+                    spdlog::info("streaming function values in chunks of {}", chunk_size);
+
+                    // double buffering: the next chunk is computed on the device while the host writes the current one
+                    // (the runtime delays reusing a buffer until the host is done with it)
+                    // trade-off: f is evaluated again on the outer grid, so that the integration stays one kernel
+                    // with a single reduction and the values never take up device memory for the whole grid;
+                    // these size extra calls are added to the function evaluations
+                    // {{UnoAPI:main-parallel-submit-parallel-for-values:begin}}
+                    const auto submit_values{[&](const size_t chunk) {
+                        const auto first{chunk * chunk_size};
+                        q.submit([&](auto & h) {
+                            const sycl::accessor v{v_bufs[chunk % 2], h, sycl::write_only, sycl::no_init};
+                            h.parallel_for(sycl::range<1>{std::min(chunk_size, size - first)}, [=](const auto & index) {
+                                v[index] = f(x_min + (first + index) * dx);
+                            });
+                        }); // end of command group
+                    }};
+                    // {{UnoAPI:main-parallel-submit-parallel-for-values:end}}
+
+                    const auto number_of_chunks{(size + chunk_size - 1) / chunk_size};
+                    submit_values(0);
+                    for (auto chunk{0UL}; chunk < number_of_chunks; chunk++) {
+                        if (chunk + 1 < number_of_chunks) {
+                            submit_values(chunk + 1);
+                        }
+                        const sycl::host_accessor values{v_bufs[chunk % 2]};
+                        writer.write(values, std::min(chunk_size, size - chunk * chunk_size));
+                    }
+                    writer.flush();
+                    evaluations += size;
+                    spdlog::info("{} function evaluations for the function values", size);
+                    mark_time(timestamps,"Output");
+                }
+                // {{UnoAPI:main-parallel-show-results-log:end}}
+            }
+        }, selected_integrand, make_rule(method_name));
     }
     // end of scope waits for the queued work to complete
 
     mark_time(timestamps,"DONE");
     spdlog::info("all done for now");
-    print_timestamps(timestamps, perf_output, device_name);
+    spdlog::info("{} function evaluations", evaluations);
+    counters.emplace_back("Function evaluations", evaluations);
+    print_timestamps(timestamps, perf_output, device_name, counters, device_timestamps);
 
-    return 0;
+    return validation_failed ? 1 : 0;
 }
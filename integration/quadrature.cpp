@@ -0,0 +1,76 @@
+#include "quadrature.h"
+
+#include <stdexcept>
+
+const std::vector<std::string> & method_names() {
+    static const std::vector<std::string> names{"trapezoid", "simpson", "gauss-legendre", "adaptive"};
+    return names;
+}
+
+fixed_rule make_rule(const std::string & name) {
+    if (name == "trapezoid") {
+        return trapezoid_rule{};
+    } else if (name == "simpson") {
+        return simpson_rule{};
+    } else if (name == "gauss-legendre") {
+        return gauss_legendre_rule{};
+    }
+    throw std::invalid_argument("not a fixed rule: " + name);
+}
+
+adaptive_result integrate_adaptive(
+    const double x_min,
+    const double x_max,
+    const double tolerance,
+    const size_t initial_intervals,
+    const size_t max_intervals,
+    const interval_evaluator & evaluate
+) {
+    constexpr auto EVALUATIONS_PER_INTERVAL{15UL};
+    adaptive_result result;
+    const auto width{x_max - x_min};
+    if (width <= 0 || initial_intervals == 0) {
+        return result;
+    }
+
+    std::vector<interval> active;
+    const auto dx{width / initial_intervals};
+    for (auto i{0UL}; i < initial_intervals; i++) {
+        active.push_back(interval{x_min + i * dx, i + 1 == initial_intervals ? x_max : x_min + (i + 1) * dx});
+    }
+
+    std::vector<estimate> estimates;
+    std::vector<interval> refined;
+    auto evaluated{0UL};
+    while (! active.empty()) {
+        estimates.resize(active.size());
+        evaluate(active, estimates);
+        evaluated += active.size();
+        result.rounds++;
+        result.evaluations += EVALUATIONS_PER_INTERVAL * active.size();
+
+        // once the budget is exhausted, accept everything that is left
+        const auto exhausted{evaluated + 2 * active.size() > max_intervals};
+        refined.clear();
+        for (auto i{0UL}; i < active.size(); i++) {
+            const auto [a, b]{active[i]};
+            const auto local_tolerance{tolerance * (b - a) / width};
+            const auto middle{0.5 * (a + b)};
+            // intervals that can no longer be bisected in double precision are accepted as well
+            const auto splittable{a < middle && middle < b};
+            if (estimates[i].error <= local_tolerance || exhausted || ! splittable) {
+                result.integral += estimates[i].integral;
+                result.error += estimates[i].error;
+                result.intervals++;
+                if (estimates[i].error > local_tolerance) {
+                    result.converged = false;
+                }
+            } else {
+                refined.push_back(interval{a, middle});
+                refined.push_back(interval{middle, b});
+            }
+        }
+        active.swap(refined);
+    }
+    return result;
+}
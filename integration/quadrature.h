@@ -0,0 +1,192 @@
+#ifndef QUADRATURE_H_
+#define QUADRATURE_H_
+
+#include <functional>
+#include <limits>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <sycl/sycl.hpp>
+
+#include "trapezoid.h"
+
+// higher-order rules for a single outer interval made of grain_size inner intervals
+// like outer_trapezoid, these are defined in the header so that they can be inlined into the kernels
+
+// composite Simpson rule as a weighted sum (ends of the domain x 1, inner grid points x 2, midpoints x 4)
+// like outer_trapezoid_weighted, each outer interval owns the left ends of its inner intervals
+template <class F> outer_result outer_simpson(
+    const F & f,
+    const size_t grain_size,
+    const double x_pos,
+    const double dx_inner,
+    const bool first,
+    const bool last
+) {
+    const auto y_left{f(x_pos)};
+    auto sum{first ? y_left : 2 * y_left};
+    for (auto j{0UL}; j < grain_size; j++) {
+        const auto x_left{x_pos + j * dx_inner};
+        if (j > 0) {
+            sum += 2 * f(x_left);
+        }
+        sum += 4 * f(x_left + 0.5 * dx_inner);
+    }
+    auto y_right{std::numeric_limits<double>::quiet_NaN()};
+    if (last) {
+        y_right = f(x_pos + grain_size * dx_inner);
+        sum += y_right;
+    }
+    return outer_result{sum * dx_inner / 6, y_left, y_right};
+}
+
+// 5-point Gauss-Legendre rule (exact for polynomials of degree <= 9)
+inline constexpr double GAUSS_LEGENDRE_5_NODES[]{0.0, 0.5384693101056831, 0.9061798459386640};
+inline constexpr double GAUSS_LEGENDRE_5_WEIGHTS[]{0.5688888888888889, 0.4786286704993665, 0.2369268850561891};
+
+template <class F> double outer_gauss_legendre(
+    const F & f,
+    const size_t grain_size,
+    const double x_pos,
+    const double dx_inner
+) {
+    const auto half_dx_inner{0.5 * dx_inner};
+    auto area{0.0};
+    for (auto j{0UL}; j < grain_size; j++) {
+        const auto center{x_pos + (j + 0.5) * dx_inner};
+        auto sum{GAUSS_LEGENDRE_5_WEIGHTS[0] * f(center)};
+        for (auto k{1}; k < 3; k++) {
+            const auto offset{GAUSS_LEGENDRE_5_NODES[k] * half_dx_inner};
+            sum += GAUSS_LEGENDRE_5_WEIGHTS[k] * (f(center - offset) + f(center + offset));
+        }
+        area += sum * half_dx_inner;
+    }
+    return area;
+}
+
+// 15-point Gauss-Kronrod rule with embedded 7-point Gauss rule
+// the difference between the two serves as the error estimate
+inline constexpr double GAUSS_KRONROD_15_NODES[]{
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.0
+};
+inline constexpr double GAUSS_KRONROD_15_WEIGHTS[]{
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+// weights of the Gauss nodes, which are the odd-indexed Kronrod nodes
+inline constexpr double GAUSS_7_WEIGHTS[]{
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+struct interval {
+    double a;
+    double b;
+};
+
+struct estimate {
+    double integral;
+    double error;
+};
+
+template <class F> estimate gauss_kronrod_15(const F & f, const double a, const double b) {
+    const auto center{0.5 * (a + b)};
+    const auto half_width{0.5 * (b - a)};
+    const auto y_center{f(center)};
+    auto kronrod{GAUSS_KRONROD_15_WEIGHTS[7] * y_center};
+    auto gauss{GAUSS_7_WEIGHTS[3] * y_center};
+    for (auto k{0}; k < 7; k++) {
+        const auto offset{GAUSS_KRONROD_15_NODES[k] * half_width};
+        const auto y_pair{f(center - offset) + f(center + offset)};
+        kronrod += GAUSS_KRONROD_15_WEIGHTS[k] * y_pair;
+        if (k % 2 == 1) {
+            gauss += GAUSS_7_WEIGHTS[k / 2] * y_pair;
+        }
+    }
+    return estimate{kronrod * half_width, sycl::fabs((kronrod - gauss) * half_width)};
+}
+
+// the fixed rules as function objects, so that the kernels can be instantiated for each of them
+// SAMPLES_OUTER_GRID tells whether the rule evaluates f at the ends of the outer intervals anyway
+// evaluations() is the number of calls of f for one outer interval
+struct trapezoid_rule {
+    static constexpr bool SAMPLES_OUTER_GRID{true};
+
+    static constexpr size_t evaluations(const size_t grain_size, const bool last) {
+        return grain_size + (last ? 1 : 0);
+    }
+
+    template <class F> outer_result operator()(const F & f, const size_t grain_size, const double x_pos, const double dx_inner, const bool first, const bool last) const {
+        return outer_trapezoid_weighted(f, grain_size, x_pos, dx_inner, first, last);
+    }
+};
+
+struct simpson_rule {
+    static constexpr bool SAMPLES_OUTER_GRID{true};
+
+    static constexpr size_t evaluations(const size_t grain_size, const bool last) {
+        return 2 * grain_size + (last ? 1 : 0);
+    }
+
+    template <class F> outer_result operator()(const F & f, const size_t grain_size, const double x_pos, const double dx_inner, const bool first, const bool last) const {
+        return outer_simpson(f, grain_size, x_pos, dx_inner, first, last);
+    }
+};
+
+struct gauss_legendre_rule {
+    static constexpr bool SAMPLES_OUTER_GRID{false};
+
+    static constexpr size_t evaluations(const size_t grain_size, const bool) {
+        return 5 * grain_size;
+    }
+
+    template <class F> outer_result operator()(const F & f, const size_t grain_size, const double x_pos, const double dx_inner, const bool, const bool) const {
+        constexpr auto NOT_SAMPLED{std::numeric_limits<double>::quiet_NaN()};
+        return outer_result{outer_gauss_legendre(f, grain_size, x_pos, dx_inner), NOT_SAMPLED, NOT_SAMPLED};
+    }
+};
+
+// total number of calls of f for all outer intervals
+template <class Rule> size_t total_evaluations(const Rule &, const size_t number_of_outer, const size_t grain_size) {
+    return number_of_outer * Rule::evaluations(grain_size, false) + Rule::evaluations(grain_size, true) - Rule::evaluations(grain_size, false);
+}
+
+using fixed_rule = std::variant<trapezoid_rule, simpson_rule, gauss_legendre_rule>;
+
+// names accepted by --method (the first one is the default, the last one is adaptive)
+const std::vector<std::string> & method_names();
+
+// looks up a fixed rule by name; throws std::invalid_argument for "adaptive" and unknown names
+fixed_rule make_rule(const std::string & name);
+
+struct adaptive_result {
+    double integral{0.0};
+    double error{0.0};
+    size_t intervals{0}; // accepted intervals
+    size_t rounds{0};
+    size_t evaluations{0}; // calls of f
+    bool converged{true};
+};
+
+// computes a Gauss-Kronrod estimate for each of the active intervals (sequentially or on a device)
+using interval_evaluator = std::function<void(const std::vector<interval> & active, std::vector<estimate> & estimates)>;
+
+// adaptive Gauss-Kronrod integration: starting from initial_intervals equal subintervals,
+// all intervals whose error exceeds their share of the tolerance are bisected and evaluated
+// again as one batch per round, until the tolerance is met or max_intervals is reached
+adaptive_result integrate_adaptive(
+    double x_min,
+    double x_max,
+    double tolerance,
+    size_t initial_intervals,
+    size_t max_intervals,
+    const interval_evaluator & evaluate
+);
+
+#endif // QUADRATURE_H_
@@ -0,0 +1,195 @@
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include "f.h"
+#include "quadrature.h"
+#include "summation.h"
+
+// host-only data-parallel versions of the fixed rules for the sequential path
+// each lane computes one outer interval, so LANES consecutive outer intervals are done per iteration
+// the inner loops are the same as in trapezoid.h and quadrature.h, so each lane matches the scalar rule
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+
+using lanes = std::experimental::native_simd<double>;
+
+#else
+// portable fallback with a fixed number of lanes: plain loops the compiler can vectorize
+class lanes {
+public:
+    static constexpr size_t size() {
+        return 4;
+    }
+
+    lanes() = default;
+
+    lanes(const double value) {
+        for (auto l{0UL}; l < size(); l++) {
+            v[l] = value;
+        }
+    }
+
+    // like the generator constructor of std::experimental::simd
+    template <class G, class = decltype(std::declval<G>()(size_t{}))> explicit lanes(const G & generator) {
+        for (auto l{0UL}; l < size(); l++) {
+            v[l] = generator(l);
+        }
+    }
+
+    double operator[](const size_t l) const {
+        return v[l];
+    }
+
+    lanes & operator+=(const lanes & other) {
+        for (auto l{0UL}; l < size(); l++) {
+            v[l] += other.v[l];
+        }
+        return *this;
+    }
+
+    friend lanes operator+(lanes a, const lanes & b) {
+        return a += b;
+    }
+
+    friend lanes operator-(const lanes & a, const lanes & b) {
+        return lanes{[&](const size_t l) { return a.v[l] - b.v[l]; }};
+    }
+
+    friend lanes operator*(const lanes & a, const lanes & b) {
+        return lanes{[&](const size_t l) { return a.v[l] * b.v[l]; }};
+    }
+
+    friend lanes operator/(const lanes & a, const lanes & b) {
+        return lanes{[&](const size_t l) { return a.v[l] / b.v[l]; }};
+    }
+
+private:
+    double v[4]{};
+};
+#endif
+
+inline double lane(const lanes & v, const size_t l) {
+    return v[l];
+}
+
+constexpr size_t LANES{lanes::size()};
+
+// f on each lane; arithmetic integrands are evaluated on whole vectors,
+// the others lane by lane (which the compiler may still vectorize with a vector math library)
+template <class F> lanes evaluate(const F & f, const lanes & x) {
+    return lanes{[&](const auto l) { return f(lane(x, l)); }};
+}
+
+inline lanes evaluate(const quadratic &, const lanes & x) {
+    return 3 * x * x;
+}
+
+inline lanes evaluate(const polynomial & p, const lanes & x) {
+    lanes y{0.0};
+    for (auto i{p.count}; i > 0; i--) {
+        y = y * x + p.coefficients[i - 1];
+    }
+    return y;
+}
+
+// area and f at the left end of LANES interior outer intervals (neither first nor last)
+struct outer_lanes {
+    lanes area;
+    lanes y_left;
+};
+
+template <class F> outer_lanes outer_lanes_of(const trapezoid_rule &, const F & f, const size_t grain_size, const lanes & x_pos, const double dx_inner) {
+    const auto y_left{evaluate(f, x_pos)};
+    auto sum{y_left};
+    for (auto j{1UL}; j < grain_size; j++) {
+        sum += evaluate(f, x_pos + j * dx_inner);
+    }
+    return outer_lanes{sum * dx_inner, y_left};
+}
+
+template <class F> outer_lanes outer_lanes_of(const simpson_rule &, const F & f, const size_t grain_size, const lanes & x_pos, const double dx_inner) {
+    const auto y_left{evaluate(f, x_pos)};
+    auto sum{2 * y_left};
+    for (auto j{0UL}; j < grain_size; j++) {
+        const auto x_left{x_pos + j * dx_inner};
+        if (j > 0) {
+            sum += 2 * evaluate(f, x_left);
+        }
+        sum += 4 * evaluate(f, x_left + 0.5 * dx_inner);
+    }
+    return outer_lanes{sum * dx_inner / 6, y_left};
+}
+
+template <class F> outer_lanes outer_lanes_of(const gauss_legendre_rule &, const F & f, const size_t grain_size, const lanes & x_pos, const double dx_inner) {
+    const auto half_dx_inner{0.5 * dx_inner};
+    lanes area{0.0};
+    for (auto j{0UL}; j < grain_size; j++) {
+        const auto center{x_pos + (j + 0.5) * dx_inner};
+        auto sum{GAUSS_LEGENDRE_5_WEIGHTS[0] * evaluate(f, center)};
+        for (auto k{1}; k < 3; k++) {
+            const auto offset{GAUSS_LEGENDRE_5_NODES[k] * half_dx_inner};
+            sum += GAUSS_LEGENDRE_5_WEIGHTS[k] * (evaluate(f, center - offset) + evaluate(f, center + offset));
+        }
+        area += sum * half_dx_inner;
+    }
+    return outer_lanes{area, lanes{std::numeric_limits<double>::quiet_NaN()}};
+}
+
+// adds the areas of all outer intervals to result in order and stores f at the outer grid in values (unless null)
+// the first and last outer intervals and the remainder that does not fill all lanes go through the scalar rule
+template <class F, class Rule> void integrate_simd(
+    const F & f,
+    const Rule & rule,
+    const size_t grain_size,
+    const double x_min,
+    const double dx,
+    const double dx_inner,
+    const size_t number_of_outer,
+    accumulator & result,
+    double * const values
+) {
+    const auto scalar{[&](const size_t i) {
+        const auto outer{rule(f, grain_size, x_min + i * dx, dx_inner, i == 0, i + 1 == number_of_outer)};
+        result.add(outer.area);
+        if (values != nullptr) {
+            values[i] = outer.y_left;
+            if (i + 1 == number_of_outer) {
+                values[i + 1] = outer.y_right;
+            }
+        }
+    }};
+
+    scalar(0);
+    auto i{1UL};
+    for (; i + LANES < number_of_outer; i += LANES) {
+        const lanes x_pos{[&](const auto l) { return x_min + (i + l) * dx; }};
+        const auto outer{outer_lanes_of(rule, f, grain_size, x_pos, dx_inner)};
+        for (auto l{0UL}; l < LANES; l++) {
+            result.add(lane(outer.area, l));
+            if (values != nullptr) {
+                values[i + l] = lane(outer.y_left, l);
+            }
+        }
+    }
+    for (; i < number_of_outer; i++) {
+        scalar(i);
+    }
+}
+
+// -s, --sequential with an optional mode: scalar or simd
+// CLI11 applies a {default} only to the name right before it, so each name carries its own
+inline CLI::Option * add_sequential_flag(CLI::App & app, std::string & mode) {
+    return app.add_flag("-s{scalar},--sequential{scalar}", mode, "run on the host instead of a device: scalar or simd (several outer intervals at a time)")
+        ->check(CLI::IsMember(std::vector<std::string>{"scalar", "simd"}));
+}
+
+#endif // SIMD_H_
@@ -0,0 +1,59 @@
+#include "summation.h"
+
+#include <stdexcept>
+
+const std::vector<std::string> & summation_names() {
+    static const std::vector<std::string> names{"naive", "kahan", "pairwise"};
+    return names;
+}
+
+summation make_summation(const std::string & name) {
+    if (name == "naive") {
+        return summation::naive;
+    } else if (name == "kahan") {
+        return summation::kahan;
+    } else if (name == "pairwise") {
+        return summation::pairwise;
+    }
+    throw std::invalid_argument("unknown summation: " + name);
+}
+
+accumulator::accumulator(const summation mode) : mode{mode} {}
+
+void accumulator::add(const double x) {
+    switch (mode) {
+    case summation::naive:
+        naive += x;
+        break;
+    case summation::kahan:
+        kahan = compensated_plus{}(kahan, compensated{x, 0.0});
+        break;
+    case summation::pairwise:
+        // like a binary counter: merge the two topmost partial sums while they have the same size
+        partials.emplace_back(x, 1);
+        while (partials.size() >= 2 && partials[partials.size() - 2].second == partials.back().second) {
+            const auto top{partials.back()};
+            partials.pop_back();
+            partials.back().first += top.first;
+            partials.back().second += top.second;
+        }
+        break;
+    }
+}
+
+double accumulator::value() const {
+    switch (mode) {
+    case summation::kahan:
+        return kahan.value();
+    case summation::pairwise: {
+        // smallest partial sums first
+        auto sum{0.0};
+        for (auto p{partials.rbegin()}; p != partials.rend(); p++) {
+            sum += p->first;
+        }
+        return sum;
+    }
+    default:
+        return naive;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef SUMMATION_H_
+#define SUMMATION_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// how the areas of the outer intervals are added up
+enum class summation { naive, kahan, pairwise };
+
+// names accepted by --summation (the first one is the default)
+const std::vector<std::string> & summation_names();
+
+// throws std::invalid_argument for unknown names
+summation make_summation(const std::string & name);
+
+// error-free transformation (Knuth's TwoSum): a + b == s + e exactly
+inline void two_sum(const double a, const double b, double & s, double & e) {
+    s = a + b;
+    const auto b_virtual{s - a};
+    e = (a - (s - b_virtual)) + (b - b_virtual);
+}
+
+// sum with a separately accumulated compensation for its rounding errors
+struct compensated {
+    double sum{0.0};
+    double correction{0.0};
+
+    double value() const {
+        return sum + correction;
+    }
+};
+
+inline constexpr compensated COMPENSATED_ZERO{0.0, 0.0};
+
+// combiner for sycl::reduction (and the host) that keeps the rounding error of every addition
+// unlike Kahan's original loop, it does not depend on the order in which partial sums are combined
+struct compensated_plus {
+    compensated operator()(const compensated & a, const compensated & b) const {
+        double s, e;
+        two_sum(a.sum, b.sum, s, e);
+        return compensated{s, a.correction + b.correction + e};
+    }
+};
+
+// running sum for the host, using the selected kind of summation
+// pairwise summation keeps a stack of partial sums of equal size, i.e., O(log n) memory
+class accumulator {
+public:
+    explicit accumulator(summation mode);
+    void add(double x);
+    double value() const;
+
+private:
+    summation mode;
+    double naive{0.0};
+    compensated kahan{COMPENSATED_ZERO};
+    std::vector<std::pair<double, size_t> > partials; // partial sum and number of terms
+};
+
+#endif // SUMMATION_H_
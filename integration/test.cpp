@@ -3,6 +3,18 @@
 
 #include "f.h"
 #include "trapezoid.h"
+#include "quadrature.h"
+#include "validate.h"
+#include "devices.h"
+#include "summation.h"
+#include "batch.h"
+#include "autotune.h"
+#include "simd.h"
+#include "threads.h"
+#include "values.h"
+
+#include <cstdio>
+#include <sstream>
 
 // {{UnoAPI:integration-test-scaffolding:begin}}
 class IntegrationTest : public testing::Test {
@@ -39,11 +51,12 @@ TEST_F(IntegrationTest, Simple3) {
 
 // {{UnoAPI:integration-test-f1:begin}}
 TEST_F(IntegrationTest, F1) {
-    EXPECT_NEAR(f(0.5), 0.75, EPS);
+    EXPECT_NEAR(quadratic{}(0.5), 0.75, EPS);
 }
 // {{UnoAPI:integration-test-f1:end}}
 
 // double outer_trapezoid(
+//     const F & f,
 //     const int grain_size,
 //     const double x_pos,
 //     const double dx_inner,
@@ -52,6 +65,319 @@ TEST_F(IntegrationTest, F1) {
 
 // {{UnoAPI:integration-test-outer1:begin}}
 TEST_F(IntegrationTest, Outer1) {
-    EXPECT_NEAR(outer_trapezoid(1000, 0.0, 0.001, 0.0005), 1, EPS);
+    EXPECT_NEAR(outer_trapezoid(quadratic{}, 1000, 0.0, 0.001, 0.0005), 1, EPS);
 }
 // {{UnoAPI:integration-test-outer1:end}}
+
+TEST_F(IntegrationTest, Polynomial) {
+    const auto p{std::get<polynomial>(make_integrand("polynomial", {1, 0, 3}))};
+    EXPECT_NEAR(p(2.0), 13, EPS);
+    EXPECT_NEAR(outer_trapezoid(p, 1000, 0.0, 0.001, 0.0005), 2, EPS);
+}
+
+TEST_F(IntegrationTest, Registry) {
+    for (const auto & name : integrand_names()) {
+        EXPECT_NO_THROW(make_integrand(name, {1}));
+    }
+    EXPECT_TRUE(std::holds_alternative<sine>(make_integrand("sin", {})));
+    EXPECT_THROW(make_integrand("tan", {}), std::invalid_argument);
+    EXPECT_THROW(make_integrand("polynomial", std::vector<double>(polynomial::MAX_COEFFICIENTS + 1)), std::invalid_argument);
+}
+
+TEST_F(IntegrationTest, Gaussian) {
+    // about 68.27% of the standard normal distribution lies within one standard deviation
+    EXPECT_NEAR(outer_trapezoid(gaussian{}, 1000, -1.0, 0.002, 0.001), 0.682689, EPS);
+}
+
+TEST_F(IntegrationTest, ValidationSampleEnds) {
+    const auto indices{validation_sample(1000, 10)};
+    EXPECT_EQ(indices.size(), 10);
+    EXPECT_EQ(indices.front(), 0);
+    EXPECT_EQ(indices.back(), 999);
+}
+
+TEST_F(IntegrationTest, ValidationSampleSmall) {
+    const auto indices{validation_sample(3, 10)};
+    EXPECT_EQ(indices, (std::vector<size_t>{0, 1, 2}));
+    EXPECT_TRUE(validation_sample(0, 10).empty());
+}
+
+TEST_F(IntegrationTest, NearlyEqual) {
+    EXPECT_TRUE(nearly_equal(1.0, 1.0 + 1e-12, 1e-9));
+    EXPECT_FALSE(nearly_equal(1.0, 1.001, 1e-9));
+}
+
+TEST_F(IntegrationTest, SimpsonCubic) {
+    // Simpson's rule is exact for cubics
+    const auto p{std::get<polynomial>(make_integrand("polynomial", {0, 0, 0, 4}))};
+    EXPECT_NEAR(outer_simpson(p, 1, 0.0, 2.0, true, true).area, 16, EPS);
+}
+
+TEST_F(IntegrationTest, GaussLegendreDegree9) {
+    const auto p{std::get<polynomial>(make_integrand("polynomial", {0, 0, 0, 0, 0, 0, 0, 0, 0, 10}))};
+    EXPECT_NEAR(outer_gauss_legendre(p, 1, 0.0, 1.0), 1, EPS);
+}
+
+TEST_F(IntegrationTest, GaussKronrod) {
+    const auto [integral, error]{gauss_kronrod_15(sine{}, 0.0, 3.141592653589793)};
+    EXPECT_NEAR(integral, 2, 1e-12);
+    EXPECT_LT(error, 1e-9);
+}
+
+TEST_F(IntegrationTest, Adaptive) {
+    const auto result{integrate_adaptive(-20, 20, 1e-12, 1, 100000, [](const auto & active, auto & estimates) {
+        for (auto i{0UL}; i < active.size(); i++) {
+            estimates[i] = gauss_kronrod_15(gaussian{}, active[i].a, active[i].b);
+        }
+    })};
+    EXPECT_TRUE(result.converged);
+    EXPECT_GT(result.rounds, 1);
+    EXPECT_NEAR(result.integral, 1, 1e-12);
+}
+
+TEST_F(IntegrationTest, AdaptiveBudget) {
+    const auto result{integrate_adaptive(0, 300, 1e-12, 1, 20, [](const auto & active, auto & estimates) {
+        for (auto i{0UL}; i < active.size(); i++) {
+            estimates[i] = gauss_kronrod_15(sine{}, active[i].a, active[i].b);
+        }
+    })};
+    EXPECT_FALSE(result.converged);
+    EXPECT_LE(result.intervals, 20);
+}
+
+TEST_F(IntegrationTest, WeightedTrapezoid) {
+    // the weighted outer trapezoids add up to the classic ones, evaluating each point once
+    auto area{0.0};
+    for (auto i{0}; i < 10; i++) {
+        area += outer_trapezoid_weighted(quadratic{}, 100, i * 0.1, 0.001, i == 0, i == 9).area;
+    }
+    EXPECT_NEAR(area, outer_trapezoid(quadratic{}, 1000, 0.0, 0.001, 0.0005), 1e-12);
+    EXPECT_EQ(total_evaluations(trapezoid_rule{}, 10, 100), 1001);
+}
+
+TEST_F(IntegrationTest, WeightedEnds) {
+    const auto outer{outer_trapezoid_weighted(quadratic{}, 10, 0.5, 0.05, false, true)};
+    EXPECT_NEAR(outer.y_left, 0.75, EPS);
+    EXPECT_NEAR(outer.y_right, 3, EPS);
+}
+
+TEST_F(IntegrationTest, PartitionOuter) {
+    const auto counts{partition_outer(1000, {1, 3})};
+    EXPECT_EQ(counts, (std::vector<size_t>{250, 750}));
+}
+
+TEST_F(IntegrationTest, PartitionOuterMinimum) {
+    // every device gets work, and the chunks always cover all outer intervals
+    const auto counts{partition_outer(10, {1, 1000, 0})};
+    EXPECT_EQ(counts.size(), 3);
+    EXPECT_GE(counts[0], 1);
+    EXPECT_GE(counts[2], 1);
+    EXPECT_EQ(counts[0] + counts[1] + counts[2], 10);
+    EXPECT_EQ(partition_outer(1, {1, 1}), (std::vector<size_t>{0, 1}));
+}
+
+TEST_F(IntegrationTest, TwoSum) {
+    double s, e;
+    two_sum(1.0, 1e-17, s, e);
+    EXPECT_EQ(s, 1.0);
+    EXPECT_EQ(e, 1e-17);
+}
+
+TEST_F(IntegrationTest, CompensatedSummation) {
+    // 1 + 10^6 * 10^-16 loses all small terms with naive summation
+    for (const auto mode : {summation::kahan, summation::pairwise}) {
+        accumulator sum{mode};
+        sum.add(1.0);
+        for (auto i{0}; i < 1000000; i++) {
+            sum.add(1e-16);
+        }
+        EXPECT_NEAR(sum.value(), 1.0 + 1e-10, 1e-15);
+    }
+    accumulator naive{summation::naive};
+    naive.add(1.0);
+    naive.add(1e-16);
+    EXPECT_EQ(naive.value(), 1.0);
+}
+
+TEST_F(IntegrationTest, CompensatedPlus) {
+    const auto sum{compensated_plus{}(compensated{1.0, 0.0}, compensated{1e-17, 0.0})};
+    EXPECT_EQ(sum.sum, 1.0);
+    EXPECT_EQ(sum.correction, 1e-17);
+}
+
+TEST_F(IntegrationTest, PairwiseOnQueue) {
+    // 1 + 3000 * 10^-16 (count not a multiple of the work-group size): the small areas survive only pairwise
+    sycl::queue q;
+    const auto outer_at{[](const size_t i) {
+        return outer_result{i == 0 ? 1.0 : 1e-16, 0.0, 0.0};
+    }};
+    EXPECT_NEAR(sum_outer_on_queue(q, outer_at, 0, 3001, summation::pairwise), 1.0 + 3e-13, 1e-15);
+    EXPECT_NEAR(sum_outer_on_queue(q, outer_at, 1, 3000, summation::pairwise), 3e-13, 1e-20);
+    EXPECT_EQ(sum_outer_on_queue(q, outer_at, 0, 0, summation::pairwise), 0.0);
+}
+
+TEST_F(IntegrationTest, BatchJobs) {
+    std::istringstream input{"# comment\nquadratic 0 1 1000 100\n\npolynomial 0 2 10 5 1 0 3\n"};
+    const auto jobs{read_batch_jobs(input)};
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_EQ(jobs[1].function_name, "polynomial");
+    EXPECT_EQ(std::get<polynomial>(jobs[1].f).count, 3);
+
+    const auto tasks{make_batch_tasks(jobs)};
+    EXPECT_EQ(tasks[1].first_outer, 10);
+    EXPECT_EQ(batch_outer_count(tasks), 12);
+
+    std::vector<double> results(tasks.size(), 0.0);
+    integrate_batch_sequentially(simpson_rule{}, tasks, results);
+    EXPECT_NEAR(results[0], 1, EPS);
+    EXPECT_NEAR(results[1], 10, EPS);
+
+    // 10 and 2 outer intervals in work-groups of 4: groups 0-2 belong to job 0 and group 3 to job 1
+    const auto group_begin{batch_group_begin(tasks, 4)};
+    EXPECT_EQ(group_begin, (std::vector<size_t>{0, 3, 4}));
+    EXPECT_EQ(batch_task_of_group(group_begin, tasks.size(), 2), 0);
+    EXPECT_EQ(batch_task_of_group(group_begin, tasks.size(), 3), 1);
+
+    sycl::queue q;
+    std::vector<double> device_results(tasks.size(), 0.0);
+    integrate_batch(q, simpson_rule{}, tasks, device_results);
+    EXPECT_NEAR(device_results[0], results[0], 1e-12);
+    EXPECT_NEAR(device_results[1], results[1], 1e-12);
+}
+
+TEST_F(IntegrationTest, BatchJobErrors) {
+    std::istringstream range{"sin 1 0 10 1\n"};
+    EXPECT_THROW(read_batch_jobs(range), std::invalid_argument);
+    std::istringstream workload{"sin 0 1 10 100\n"};
+    EXPECT_THROW(read_batch_jobs(workload), std::invalid_argument);
+    std::istringstream coefficient{"polynomial 0 1 10 1 1 x\n"};
+    EXPECT_THROW(read_batch_jobs(coefficient), std::invalid_argument);
+}
+
+TEST_F(IntegrationTest, AutotuneCandidates) {
+    EXPECT_EQ(geometric_candidates(100, 4), (std::vector<size_t>{1, 4, 16, 64, 100}));
+    EXPECT_EQ(geometric_candidates(64, 4), (std::vector<size_t>{1, 4, 16, 64}));
+    EXPECT_EQ(geometric_candidates(1, 4), (std::vector<size_t>{1}));
+    EXPECT_EQ(refinement_candidates(16, 100, 4), (std::vector<size_t>{8, 32, 10, 24}));
+    EXPECT_EQ(refinement_candidates(1, 100, 4), (std::vector<size_t>{2}));
+}
+
+TEST_F(IntegrationTest, TuningCache) {
+    const std::string path{testing::TempDir() + "integration-tuning-test.tsv"};
+    std::remove(path.c_str());
+    EXPECT_FALSE(lookup_grain_size(path, "gpu", 1000, "trapezoid").has_value());
+    ASSERT_TRUE(store_grain_size(path, "gpu", 1000, "trapezoid", 10));
+    ASSERT_TRUE(store_grain_size(path, "cpu, 8 cores", 1000, "trapezoid", 100));
+    ASSERT_TRUE(store_grain_size(path, "gpu", 1000, "trapezoid", 20));
+    EXPECT_EQ(lookup_grain_size(path, "gpu", 1000, "trapezoid"), 20);
+    EXPECT_EQ(lookup_grain_size(path, "cpu, 8 cores", 1000, "trapezoid"), 100);
+    EXPECT_FALSE(lookup_grain_size(path, "gpu", 1000, "simpson").has_value());
+    EXPECT_FALSE(lookup_grain_size(path, "gpu", 2000, "trapezoid").has_value());
+    std::remove(path.c_str());
+}
+
+TEST_F(IntegrationTest, SimdMatchesScalar) {
+    constexpr size_t number_of_outer{37};
+    constexpr int grain_size{10};
+    const auto dx{2.0 / number_of_outer};
+    const auto dx_inner{dx / grain_size};
+    for (const auto & name : integrand_names()) {
+        const auto f{make_integrand(name, {1, -2, 0.5})};
+        for (const auto & method : {"trapezoid", "simpson", "gauss-legendre"}) {
+            std::visit([&](const auto & f, const auto & rule) {
+                accumulator scalar{summation::naive};
+                std::vector<double> scalar_values(number_of_outer + 1);
+                for (auto i{0UL}; i < number_of_outer; i++) {
+                    const auto outer{rule(f, grain_size, -1.0 + i * dx, dx_inner, i == 0, i + 1 == number_of_outer)};
+                    scalar.add(outer.area);
+                    scalar_values[i] = outer.y_left;
+                }
+                accumulator simd{summation::naive};
+                std::vector<double> simd_values(number_of_outer + 1);
+                integrate_simd(f, rule, grain_size, -1.0, dx, dx_inner, number_of_outer, simd, simd_values.data());
+                EXPECT_NEAR(simd.value(), scalar.value(), EPS) << name << " " << method;
+                if (std::decay_t<decltype(rule)>::SAMPLES_OUTER_GRID) {
+                    EXPECT_NEAR(simd_values[number_of_outer / 2], scalar_values[number_of_outer / 2], EPS) << name << " " << method;
+                }
+            }, f, make_rule(method));
+        }
+    }
+}
+
+TEST_F(IntegrationTest, SequentialFlag) {
+    const auto parse{[](std::vector<const char *> args) {
+        args.insert(args.begin(), "integration");
+        CLI::App app;
+        std::string mode;
+        add_sequential_flag(app, mode);
+        app.parse(static_cast<int>(args.size()), args.data());
+        return mode;
+    }};
+    EXPECT_EQ(parse({}), "");
+    EXPECT_EQ(parse({"-s"}), "scalar");
+    EXPECT_EQ(parse({"--sequential"}), "scalar");
+    EXPECT_EQ(parse({"--sequential=simd"}), "simd");
+    EXPECT_THROW(parse({"--sequential=vector"}), CLI::ParseError);
+}
+
+TEST_F(IntegrationTest, ThreadsBackend) {
+    std::vector<int> visits(1001, 0);
+    for_each_chunk(visits.size(), 4, 7, [&](const size_t begin, const size_t end) {
+        for (auto i{begin}; i < end; i++) {
+            visits[i]++;
+        }
+    });
+    EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), visits.size());
+
+    constexpr size_t number_of_outer{1000};
+    constexpr int grain_size{10};
+    const auto dx{1.0 / number_of_outer};
+    const auto outer_at{[=](const size_t i) {
+        return trapezoid_rule{}(quadratic{}, grain_size, i * dx, dx / grain_size, i == 0, i + 1 == number_of_outer);
+    }};
+    std::vector<double> values(number_of_outer + 1);
+    for (const auto mode : {summation::naive, summation::kahan, summation::pairwise}) {
+        EXPECT_NEAR(sum_outer_on_threads(outer_at, number_of_outer, 3, mode, values.data()), 1, EPS);
+    }
+    EXPECT_NEAR(values[number_of_outer / 2], quadratic{}(0.5), EPS);
+    EXPECT_NEAR(values[number_of_outer], quadratic{}(1.0), EPS);
+}
+
+TEST_F(IntegrationTest, ValueWriter) {
+    const std::vector<double> values{1.0, 2.5, -3.0};
+    const auto read_back{[](std::FILE * file) {
+        std::string content;
+        std::rewind(file);
+        for (int c; (c = std::fgetc(file)) != EOF;) {
+            content.push_back(static_cast<char>(c));
+        }
+        return content;
+    }};
+
+    std::FILE * text{std::tmpfile()};
+    ASSERT_NE(text, nullptr);
+    {
+        value_writer writer{text, values_format::text, 0.0, 0.5, 1, 2};
+        writer.write(values, 2);
+        writer.write(std::vector<double>{values[2]}, 1);
+        EXPECT_EQ(writer.count(), 3);
+    }
+    EXPECT_EQ(read_back(text), "0: f(0.0) = 1.00\n1: f(0.5) = 2.50\n2: f(1.0) = -3.00\n");
+    std::fclose(text);
+
+    std::FILE * binary{std::tmpfile()};
+    ASSERT_NE(binary, nullptr);
+    {
+        value_writer writer{binary, values_format::binary, 0.0, 0.5, 1, 2};
+        writer.write(values, values.size());
+    }
+    const auto bytes{read_back(binary)};
+    std::fclose(binary);
+    ASSERT_EQ(bytes.size(), 3 * sizeof(double));
+    // 2.5 = 0x4004000000000000, least significant byte first
+    EXPECT_EQ(static_cast<unsigned char>(bytes[sizeof(double) + 7]), 0x40);
+    EXPECT_EQ(static_cast<unsigned char>(bytes[sizeof(double) + 6]), 0x04);
+    EXPECT_EQ(bytes[sizeof(double)], 0);
+
+    EXPECT_THROW(make_values_format("csv"), std::invalid_argument);
+}
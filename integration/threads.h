@@ -0,0 +1,71 @@
+#ifndef THREADS_H_
+#define THREADS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "summation.h"
+
+// host-only backend on plain threads, as a baseline for the SYCL CPU device without the SYCL runtime
+
+// enough chunks per thread to balance the load, but at least one index per chunk
+inline size_t default_chunk_size(const size_t count, const size_t threads) {
+    constexpr size_t CHUNKS_PER_THREAD{16};
+    return std::max<size_t>(1, count / (CHUNKS_PER_THREAD * threads));
+}
+
+// calls body(begin, end) for the chunks of [0, count) on the given number of threads (including the caller)
+// the threads take the next chunk from a shared counter when they are done, so faster threads take more chunks
+template <class Body> void for_each_chunk(const size_t count, const size_t threads, const size_t chunk_size, const Body & body) {
+    std::atomic<size_t> next{0};
+    const auto work{[&] {
+        for (auto begin{next.fetch_add(chunk_size)}; begin < count; begin = next.fetch_add(chunk_size)) {
+            body(begin, std::min(begin + chunk_size, count));
+        }
+    }};
+    std::vector<std::thread> workers;
+    for (auto t{1UL}; t < threads; t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+// sums the areas outer_at(i) for i in [0, count) on the given number of threads
+// and stores f at the outer grid in values (unless null)
+// the sums of the chunks are added in order, so the result does not depend on the scheduling
+template <class OuterAt> double sum_outer_on_threads(
+    const OuterAt & outer_at,
+    const size_t count,
+    const size_t threads,
+    const summation mode,
+    double * const values
+) {
+    const auto chunk_size{default_chunk_size(count, threads)};
+    std::vector<double> partials((count + chunk_size - 1) / chunk_size, 0.0);
+    for_each_chunk(count, threads, chunk_size, [&](const size_t begin, const size_t end) {
+        accumulator partial{mode};
+        for (auto i{begin}; i < end; i++) {
+            const auto outer{outer_at(i)};
+            partial.add(outer.area);
+            if (values != nullptr) {
+                values[i] = outer.y_left;
+                if (i + 1 == count) {
+                    values[i + 1] = outer.y_right;
+                }
+            }
+        }
+        partials[begin / chunk_size] = partial.value();
+    });
+    accumulator result{mode};
+    for (const auto partial : partials) {
+        result.add(partial);
+    }
+    return result.value();
+}
+
+#endif // THREADS_H_
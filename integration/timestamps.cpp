@@ -10,13 +10,14 @@ void mark_time(ts_vector & timestamps, const std::string_view label) {
 // {{UnoAPI:timestamps-mark-time:end}}
 
 // {{UnoAPI:timestamps-print-timestamps:begin}}
-void print_timestamps(const ts_vector & timestamps, const std::string_view filename, const std::string_view device_name) {
+void print_timestamps(const ts_vector & timestamps, const std::string_view filename, const std::string_view device_name, const counter_vector & counters, const device_ts_vector & device_timestamps) {
     using std::chrono::nanoseconds;
     using std::chrono::duration_cast;
 
     constexpr auto ROW_HEADER{"TIME,DELTA,UNIT,DEVICE,PHASE\n"};
     constexpr auto ROW_FORMAT{"{},{},{},{},{}\n"};
     constexpr auto TIME_UNIT{"ns"};
+    constexpr auto COUNT_UNIT{"count"};
 
     const auto & start = timestamps.front().second;
     auto outfile = filename.empty() ? stdout : std::fopen(filename.data(), "w");
@@ -29,6 +30,13 @@ void print_timestamps(const ts_vector & timestamps, const std::string_view filen
     const auto & stop{timestamps.back().second};
     const auto total{duration_cast<nanoseconds>(stop - start).count()};
     fmt::print(outfile, ROW_FORMAT, duration_cast<nanoseconds>(stop.time_since_epoch()).count(), total, TIME_UNIT, device_name, "TOTAL");
+    for (const auto & [device, label, device_start, device_stop] : device_timestamps) {
+        const auto dur{duration_cast<nanoseconds>(device_stop - device_start).count()};
+        fmt::print(outfile, ROW_FORMAT, duration_cast<nanoseconds>(device_stop.time_since_epoch()).count(), dur, TIME_UNIT, device, label);
+    }
+    for (const auto & [label, count] : counters) {
+        fmt::print(outfile, ROW_FORMAT, duration_cast<nanoseconds>(stop.time_since_epoch()).count(), count, COUNT_UNIT, device_name, label);
+    }
     if (! filename.empty())
         std::fclose(outfile);
 }
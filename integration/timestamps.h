@@ -4,11 +4,25 @@
 #include <vector>
 #include <unordered_map>
 #include <chrono>
+#include <string>
+#include <string_view>
 
 // can use const pair with clang++ but not g++
 typedef std::vector<std::pair<const std::string, const std::chrono::steady_clock::time_point> > ts_vector;
 
+// totals reported after the timings, one row each (e.g., number of function evaluations)
+typedef std::vector<std::pair<std::string, size_t> > counter_vector;
+
+// phases that overlap in time on different devices (e.g., multi-device integration), one row each
+struct device_timestamp {
+    std::string device_name;
+    std::string label;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point stop;
+};
+typedef std::vector<device_timestamp> device_ts_vector;
+
 void mark_time(ts_vector& timestamps, std::string_view label);
-void print_timestamps(const ts_vector & timestamps, std::string_view filename, std::string_view device_name);
+void print_timestamps(const ts_vector & timestamps, std::string_view filename, std::string_view device_name, const counter_vector & counters = {}, const device_ts_vector & device_timestamps = {});
 
 #endif // INTEGRATION_TIMESTAMPS_H
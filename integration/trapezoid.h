@@ -1,17 +1,72 @@
 #ifndef INTEGRATION_H_
 #define INTEGRATION_H_
 
+#include <limits>
+
 #include <sycl/sycl.hpp>
 
+// defined in the header so that they can be inlined into the kernels
+
 // {{UnoAPI:trapezoid-interface:begin}}
-SYCL_EXTERNAL double single_trapezoid(double f1, double f2, double dx);
+// {{UnoAPI:trapezoid-implementation:begin}}
+inline double single_trapezoid(const double f1, const double f2, const double half_dx) {
+  return (f1 + f2) * half_dx;
+}
+// {{UnoAPI:trapezoid-implementation:end}}
 // {{UnoAPI:trapezoid-interface:end}}
 
-SYCL_EXTERNAL double outer_trapezoid(
-    const int grain_size,
+// {{UnoAPI:trapezoid-compute-outer:begin}}
+// common function to compute a single outer trapezoid
+// from as many inner trapezoids as the grain size
+template <class F> double outer_trapezoid(
+    const F & f,
+    const size_t grain_size,
     const double x_pos,
     const double dx_inner,
     const double half_dx_inner
-);
+) {
+    auto area{0.0};
+    auto y_left{f(x_pos)};
+    for (auto j{0UL}; j < grain_size; j++) {
+        auto y_right{f(x_pos + (j + 1) * dx_inner)};
+        area += single_trapezoid(y_left, y_right, half_dx_inner);
+        y_left = y_right;
+    }
+    return area;
+}
+// {{UnoAPI:trapezoid-compute-outer:end}}
+
+// area of one outer interval together with f at its ends (NaN where not sampled)
+struct outer_result {
+    double area;
+    double y_left;
+    double y_right;
+};
+
+// {{UnoAPI:trapezoid-compute-outer-weighted:begin}}
+// the same outer trapezoid as a weighted sum (ends of the domain x 1/2, interior points x 1)
+// each outer trapezoid owns the left ends of its inner trapezoids, and the last one also owns
+// the right end of the domain, so every point is evaluated exactly once across all outer trapezoids
+template <class F> outer_result outer_trapezoid_weighted(
+    const F & f,
+    const size_t grain_size,
+    const double x_pos,
+    const double dx_inner,
+    const bool first,
+    const bool last
+) {
+    const auto y_left{f(x_pos)};
+    auto sum{first ? 0.5 * y_left : y_left};
+    for (auto j{1UL}; j < grain_size; j++) {
+        sum += f(x_pos + j * dx_inner);
+    }
+    auto y_right{std::numeric_limits<double>::quiet_NaN()};
+    if (last) {
+        y_right = f(x_pos + grain_size * dx_inner);
+        sum += 0.5 * y_right;
+    }
+    return outer_result{sum * dx_inner, y_left, y_right};
+}
+// {{UnoAPI:trapezoid-compute-outer-weighted:end}}
 
 #endif // INTEGRATION_H_
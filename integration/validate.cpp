@@ -0,0 +1,28 @@
+#include "validate.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<size_t> validation_sample(const size_t number_of_trapezoids, const size_t sample_size) {
+    std::vector<size_t> indices;
+    if (number_of_trapezoids == 0 || sample_size == 0) {
+        return indices;
+    }
+    const auto count{std::min(sample_size, number_of_trapezoids)};
+    if (count == 1) {
+        indices.push_back(number_of_trapezoids - 1);
+        return indices;
+    }
+    // spread the samples over [0, number_of_trapezoids - 1] including both ends
+    const auto last{number_of_trapezoids - 1};
+    for (auto i{0UL}; i < count; i++) {
+        indices.push_back(i * last / (count - 1));
+    }
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    return indices;
+}
+
+bool nearly_equal(const double expected, const double actual, const double tolerance) {
+    const auto scale{std::max(1.0, std::max(std::fabs(expected), std::fabs(actual)))};
+    return std::fabs(expected - actual) <= tolerance * scale;
+}
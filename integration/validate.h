@@ -0,0 +1,14 @@
+#ifndef VALIDATE_H_
+#define VALIDATE_H_
+
+#include <cstddef>
+#include <vector>
+
+// evenly spaced indices of the outer trapezoids to recheck sequentially
+// always includes the first and the last trapezoid (where range errors show up)
+std::vector<size_t> validation_sample(size_t number_of_trapezoids, size_t sample_size);
+
+// relative comparison with an absolute fallback for values close to zero
+bool nearly_equal(double expected, double actual, double tolerance);
+
+#endif // VALIDATE_H_
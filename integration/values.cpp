@@ -0,0 +1,53 @@
+#include "values.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+const std::vector<std::string> & values_format_names() {
+    static const std::vector<std::string> names{"text", "binary"};
+    return names;
+}
+
+values_format make_values_format(const std::string & name) {
+    if (name == "text") {
+        return values_format::text;
+    } else if (name == "binary") {
+        return values_format::binary;
+    }
+    throw std::invalid_argument{"unknown values format: " + name};
+}
+
+value_writer::value_writer(std::FILE * const output, const values_format format, const double x_min, const double dx, const unsigned x_precision, const unsigned y_precision) :
+    output{output}, format{format}, x_min{x_min}, dx{dx}, x_precision{x_precision}, y_precision{y_precision} {
+}
+
+value_writer::~value_writer() {
+    flush();
+}
+
+void value_writer::append(const double y) {
+    if (format == values_format::text) {
+        fmt::format_to(std::back_inserter(buffer), "{}: f({:.{}f}) = {:.{}f}\n", next_index, x_min + next_index * dx, x_precision, y, y_precision);
+    } else {
+        // assemble the little-endian bytes explicitly, independent of the byte order of the host
+        std::uint64_t bits;
+        std::memcpy(&bits, &y, sizeof bits);
+        char bytes[sizeof bits];
+        for (auto b{0UL}; b < sizeof bits; b++) {
+            bytes[b] = static_cast<char>((bits >> (8 * b)) & 0xff);
+        }
+        buffer.append(bytes, bytes + sizeof bytes);
+    }
+    next_index++;
+    if (buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void value_writer::flush() {
+    std::fwrite(buffer.data(), 1, buffer.size(), output);
+    std::fflush(output);
+    buffer.clear();
+}
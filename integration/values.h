@@ -0,0 +1,62 @@
+#ifndef VALUES_H_
+#define VALUES_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+// output of the function values on the outer grid (-v)
+// text: one line "i: f(x) = y" per value
+// binary: raw little-endian doubles y_0, y_1, ... (x_i = x_min + i dx is implied)
+enum class values_format {
+    text,
+    binary
+};
+
+// names accepted by --values-format (the first one is the default)
+const std::vector<std::string> & values_format_names();
+
+// throws std::invalid_argument for unknown names
+values_format make_values_format(const std::string & name);
+
+// buffered writer that takes the values in consecutive chunks, so that they never need to be in memory all at once
+// the output is written whenever the buffer is full and at the latest when the writer goes out of scope
+class value_writer {
+public:
+    value_writer(std::FILE * output, values_format format, double x_min, double dx, unsigned x_precision, unsigned y_precision);
+    value_writer(const value_writer &) = delete;
+    value_writer & operator=(const value_writer &) = delete;
+    ~value_writer();
+
+    // appends values[0], ..., values[count - 1] as the next values (Indexable: vector, host accessor, ...)
+    template <class Indexable> void write(const Indexable & values, const size_t count) {
+        for (auto k{0UL}; k < count; k++) {
+            append(values[k]);
+        }
+    }
+
+    void flush();
+
+    // number of values written so far
+    size_t count() const {
+        return next_index;
+    }
+
+private:
+    void append(double y);
+
+    static constexpr size_t BUFFER_SIZE{1 << 20};
+
+    std::FILE * output;
+    values_format format;
+    double x_min;
+    double dx;
+    unsigned x_precision;
+    unsigned y_precision;
+    size_t next_index{0};
+    fmt::memory_buffer buffer;
+};
+
+#endif // VALUES_H_
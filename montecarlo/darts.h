@@ -0,0 +1,274 @@
+#ifndef DARTS_H
+#define DARTS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <sycl/sycl.hpp>
+#include <oneapi/dpl/random>
+
+#include "philox.h"
+
+constexpr uint64_t R{3037000493UL}; // largest prime <= sqrt(ULONG_MAX / 2)
+
+// A dart stream yields the coordinates in [0, R] of one player's darts:
+// Stream(seed, player) starts at the player's first dart and operator() returns the next one.
+// Seekable streams also jump to any dart with seek(dart), so a player's darts can be split across work items
+// with the same per-player counts as a sequential loop.
+
+// offset-seeded oneDPL engine: player p starts 37 * p + 13 draws into the sequence of the seed
+template <typename Engine>
+class offset_stream {
+public:
+    static constexpr bool seekable{false};
+
+    offset_stream(const uint64_t seed, const uint64_t player)
+        : engine(seed, 37 * player + 13), distr(0, R) {}
+
+    std::array<uint64_t, 2> operator()() {
+        const auto x{distr(engine)};
+        const auto y{distr(engine)};
+        return {x, y};
+    }
+
+private:
+    Engine engine;
+    oneapi::dpl::uniform_int_distribution<uint64_t> distr;
+};
+
+// the offset-seeded minstd stream of offset_stream<oneapi::dpl::minstd_rand>, made seekable:
+// minstd is x' = 48271 x mod (2^31 - 1), so the state k draws ahead is 48271^k x mod (2^31 - 1),
+// and reseeding the engine with it continues the same sequence (each dart takes two draws,
+// as the oneDPL distributions take one engine value per sample)
+class minstd_stream {
+public:
+    static constexpr bool seekable{true};
+
+    minstd_stream(const uint64_t seed, const uint64_t player)
+        : first(power(37 * player + 13) * (seed % M == 0 ? 1 : seed % M) % M), engine(first), distr(0, R) {}
+
+    void seek(const uint64_t i) { engine.seed(power(2 * i) * first % M); }
+
+    std::array<uint64_t, 2> operator()() {
+        const auto x{distr(engine)};
+        const auto y{distr(engine)};
+        return {x, y};
+    }
+
+private:
+    static constexpr uint64_t A{48271};
+    static constexpr uint64_t M{2147483647}; // 2^31 - 1
+
+    // A^n mod M by squaring (all factors are below 2^31, so products fit into 64 bits)
+    static uint64_t power(uint64_t n) {
+        uint64_t result{1};
+        for (uint64_t a{A}; n > 0; n >>= 1, a = a * a % M) {
+            if (n & 1)
+                result = result * a % M;
+        }
+        return result;
+    }
+
+    uint64_t first;
+    oneapi::dpl::minstd_rand engine;
+    oneapi::dpl::uniform_int_distribution<uint64_t> distr;
+};
+
+// counter-based philox4x32: dart i of player p is drawn from (seed, i, p) alone
+class philox_stream {
+public:
+    static constexpr bool seekable{true};
+
+    philox_stream(const uint64_t seed, const uint64_t player)
+        : philox(seed), player(player) {}
+
+    void seek(const uint64_t i) { dart = i; }
+
+    std::array<uint64_t, 2> operator()() {
+        const auto [x_bits, y_bits] = philox(dart++, player);
+        return {scale_to(x_bits, R + 1), scale_to(y_bits, R + 1)};
+    }
+
+private:
+    philox4x32 philox;
+    uint64_t player;
+    uint64_t dart{0};
+};
+
+// multiplicative congruential generator x' = 13^13 x mod 2^59 (as mcg59 in oneMKL);
+// player p gets the block of 2^40 draws starting at p * 2^40, and seek jumps ahead in O(log dart)
+class mcg59_stream {
+public:
+    static constexpr bool seekable{true};
+
+    mcg59_stream(const uint64_t seed, const uint64_t player)
+        : first(power(player << 40) * ((2 * seed + 1) & MASK) & MASK), state(first) {}
+
+    void seek(const uint64_t i) { state = power(2 * i) * first & MASK; }
+
+    std::array<uint64_t, 2> operator()() {
+        state = A * state & MASK;
+        const auto x{scale_to(state << 5, R + 1)};
+        state = A * state & MASK;
+        const auto y{scale_to(state << 5, R + 1)};
+        return {x, y};
+    }
+
+private:
+    static constexpr uint64_t A{302875106592253UL}; // 13^13
+    static constexpr uint64_t MASK{(1UL << 59) - 1};
+
+    // A^n mod 2^59 by squaring: products wrap modulo 2^64, which 2^59 divides
+    static uint64_t power(uint64_t n) {
+        uint64_t result{1};
+        for (uint64_t a{A}; n > 0; n >>= 1, a = a * a & MASK) {
+            if (n & 1)
+                result = result * a & MASK;
+        }
+        return result;
+    }
+
+    uint64_t first;
+    uint64_t state;
+};
+
+struct dart_config {
+    uint64_t seed;
+    size_t number_of_players;
+    uint64_t number_of_darts;
+    size_t work_group_size;   // seekable streams only
+    uint64_t darts_per_item;  // seekable streams only (0: derived from the compute units of the device)
+};
+
+// darts per work item for a launch of about GROUPS_PER_COMPUTE_UNIT work-groups on every compute unit,
+// so that even a few players keep all cores of a CPU busy (CPU runtimes run one work-group per thread)
+inline uint64_t default_darts_per_item(const dart_config &config, const size_t work_group_size, const size_t compute_units) {
+    constexpr size_t GROUPS_PER_COMPUTE_UNIT{4};
+    constexpr uint64_t MIN_DARTS_PER_ITEM{64}; // keeps the skip-ahead of each work item cheap
+    const size_t groups_per_player{std::max<size_t>(1, (GROUPS_PER_COMPUTE_UNIT * compute_units + config.number_of_players - 1) / config.number_of_players)};
+    const uint64_t items_per_player{groups_per_player * work_group_size};
+    return std::max(MIN_DARTS_PER_ITEM, (config.number_of_darts + items_per_player - 1) / items_per_player);
+}
+
+// number of darts of one player within the circle, thrown sequentially on the host
+template <typename Stream>
+uint64_t count_darts(const dart_config &config, const uint64_t player) {
+    Stream stream(config.seed, player);
+    auto darts_within_circle{0UL};
+    for (auto i{0UL}; i < config.number_of_darts; i++) {
+        const auto [x, y] = stream();
+        if (x * x + y * y <= R * R)
+            darts_within_circle++;
+    }
+    return darts_within_circle;
+}
+
+// Fills c_buf with the number of darts of each player within the circle.
+// Seekable streams split every player's darts into slices of darts_per_item, one per work item;
+// each work-group belongs to one player and leaves one partial count (tree reduction in local memory),
+// and a second kernel adds up the partial counts of each player.
+// Other streams throw all darts of a player in one work item.
+template <typename Stream>
+void submit_darts(sycl::queue &q, sycl::buffer<uint64_t> &c_buf, const dart_config &config) {
+    const auto seed{config.seed};
+    const auto number_of_darts{config.number_of_darts};
+
+    if constexpr (Stream::seekable) {
+        const size_t wg{std::min<size_t>(config.work_group_size, q.get_device().get_info<sycl::info::device::max_work_group_size>())};
+        const auto darts_per_item{config.darts_per_item > 0 ? config.darts_per_item
+            : default_darts_per_item(config, wg, q.get_device().get_info<sycl::info::device::max_compute_units>())};
+        const uint64_t items_per_player{(number_of_darts + darts_per_item - 1) / darts_per_item};
+        const size_t groups_per_player{std::max<size_t>(1, (items_per_player + wg - 1) / wg)};
+        const size_t number_of_groups{config.number_of_players * groups_per_player};
+        sycl::buffer<uint64_t> partial_buf{sycl::range<1>(number_of_groups)};
+
+        q.submit([&](auto &h) {
+            const sycl::accessor partial{partial_buf, h, sycl::write_only, sycl::no_init};
+            sycl::local_accessor<uint64_t> group_counts{sycl::range<1>(wg), h};
+
+            h.parallel_for(sycl::nd_range<1>{number_of_groups * wg, wg}, [=](const auto &item) {
+                const auto group{item.get_group_linear_id()};
+                const auto local_id{item.get_local_linear_id()};
+                const uint64_t player{group / groups_per_player};
+                const uint64_t slice{(group % groups_per_player) * wg + local_id};
+                const auto begin{std::min(slice * darts_per_item, number_of_darts)};
+                const auto end{std::min(begin + darts_per_item, number_of_darts)};
+
+                Stream stream(seed, player);
+                stream.seek(begin);
+                auto darts_within_circle{0UL};
+                for (auto i{begin}; i < end; i++) {
+                    const auto [x, y] = stream();
+                    if (x * x + y * y <= R * R)
+                        darts_within_circle++;
+                }
+
+                // tree reduction of the work-group in local memory, for any work-group size
+                group_counts[local_id] = darts_within_circle;
+                auto stride{1UL};
+                while (2 * stride < wg)
+                    stride *= 2;
+                for (; stride > 0; stride /= 2) {
+                    sycl::group_barrier(item.get_group());
+                    if (local_id < stride && local_id + stride < wg)
+                        group_counts[local_id] += group_counts[local_id + stride];
+                }
+                if (local_id == 0)
+                    partial[group] = group_counts[0];
+            });
+        });
+
+        q.submit([&](auto &h) {
+            const sycl::accessor partial{partial_buf, h, sycl::read_only};
+            const auto c = c_buf.template get_access<sycl::access_mode::write>(h);
+
+            h.parallel_for(config.number_of_players, [=](const auto index) {
+                const auto first{index.get_linear_id() * groups_per_player};
+                auto darts_within_circle{0UL};
+                for (auto g{first}; g < first + groups_per_player; g++)
+                    darts_within_circle += partial[g];
+                c[index] = darts_within_circle;
+            });
+        });
+    }
+    else {
+        q.submit([&](auto &h) {
+            const auto c = c_buf.template get_access<sycl::access_mode::write>(h);
+
+            h.parallel_for(config.number_of_players, [=](const auto index) {
+                Stream stream(seed, index.get_linear_id());
+                auto darts_within_circle{0UL};
+                for (auto i{0UL}; i < number_of_darts; i++) {
+                    const auto [x, y] = stream();
+                    if (x * x + y * y <= R * R)
+                        darts_within_circle++;
+                }
+                c[index] = darts_within_circle;
+            });
+        });
+    }
+}
+
+// registry of the engines by name: the kernel is instantiated per engine and picked once at submit time
+struct dart_engine {
+    void (*submit)(sycl::queue &, sycl::buffer<uint64_t> &, const dart_config &);
+    uint64_t (*count)(const dart_config &, uint64_t);
+};
+
+template <typename Stream>
+constexpr dart_engine make_dart_engine() {
+    return dart_engine{submit_darts<Stream>, count_darts<Stream>};
+}
+
+inline const std::map<std::string, dart_engine> dart_engines{
+    {"minstd", make_dart_engine<minstd_stream>()},
+    {"ranlux24", make_dart_engine<offset_stream<oneapi::dpl::ranlux24>>()},
+    {"ranlux48", make_dart_engine<offset_stream<oneapi::dpl::ranlux48>>()},
+    {"philox", make_dart_engine<philox_stream>()},
+    {"mcg59", make_dart_engine<mcg59_stream>()},
+};
+
+#endif
@@ -8,30 +8,52 @@
 // dpc_common.hpp can be found in the dev-utilities include folder.
 // e.g., $ONEAPI_ROOT/dev-utilities/<version>/include/dpc_common.hpp
 #include <sycl/sycl.hpp>
-#include <oneapi/dpl/random>
 #include <dpc_common.hpp>
 //#include <sycl/ext/intel/ac_types/ac_int.hpp>
 
+#include "darts.h"
+
 int main(const int argc, const char *const argv[]) {
     constexpr size_t DEFAULT_NUMBER_OF_PLAYERS{4};
     constexpr uint64_t DEFAULT_NUMBER_OF_DARTS{1000000};
     size_t number_of_players{DEFAULT_NUMBER_OF_PLAYERS};
     uint64_t number_of_darts{DEFAULT_NUMBER_OF_DARTS};
     bool randomize{false};
+    std::string engine_name{"minstd"};
     bool use_ranlux{false};
+    size_t work_group_size{256};
+    uint64_t darts_per_item{0}; // derived from the device unless given
+    bool verify{false};
 
     CLI::App app{"Monte Carlo algorithm for estimating pi"};
     app.add_option("-p,--players", number_of_players, "number of players");
     app.add_option("-n,--darts", number_of_darts, "number of darts per player");
     app.add_flag("-r,--randomize", randomize, "randomize dart locations");
-    app.add_flag("-l,--ranlux", use_ranlux, "use ranlux instead of LCG (minstd) for random number generation");
+    std::vector<std::string> engine_names;
+    for (const auto &[name, engine] : dart_engines)
+        engine_names.push_back(name);
+    const auto engine_option = app.add_option("-e,--engine", engine_name,
+        "random number engine: ranlux throws a player's darts in one work item, "
+        "minstd and mcg59 (skip-ahead) and philox (counter-based) split them across work items")
+        ->check(CLI::IsMember(engine_names));
+    app.add_flag("-l,--ranlux", use_ranlux, "same as --engine ranlux48")
+        ->excludes(engine_option);
+    app.add_option("-w,--work-group-size", work_group_size, "work items per work-group of the minstd, philox and mcg59 kernels (clamped to the device maximum)")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--darts-per-item", darts_per_item, "darts thrown by each work item of the minstd, philox and mcg59 kernels (default: enough work-groups for several per compute unit)")
+        ->check(CLI::PositiveNumber);
+    app.add_flag("--verify", verify, "check the per-player counts against a sequential loop on the host");
     CLI11_PARSE(app, argc, argv);
+    if (use_ranlux)
+        engine_name = "ranlux48";
+    const auto &engine{dart_engines.at(engine_name)};
 
     spdlog::info("{} players are going to throw {} darts each", number_of_players, number_of_darts);
-    spdlog::info("using {} engine with real distribution", use_ranlux ? "ranlux" : "minstd");
+    spdlog::info("using {} engine", engine_name);
     spdlog::info("randomization is {}", randomize ? "on" : "off");
 
-    const auto seed = randomize ? time(nullptr) : 0;
+    const uint64_t seed = randomize ? time(nullptr) : 0;
+    const dart_config config{seed, number_of_players, number_of_darts, work_group_size, darts_per_item};
     std::vector<uint64_t> counts(number_of_players, 0);
     uint64_t sum{0};
 
@@ -44,31 +66,7 @@ int main(const int argc, const char *const argv[]) {
         spdlog::info("Max workgroup size: {}", q.get_device().get_info<sycl::info::device::max_work_group_size>());
 
         // {{UnoAPI:montecarlo-queue-dart-throwing:begin}}
-        q.submit([&](auto &h) {
-            const auto c = c_buf.get_access<sycl::access_mode::write>(h);
-
-            h.parallel_for(number_of_players, [=](const auto index) {
-                const auto offset = 37 * index.get_linear_id() + 13;
-                oneapi::dpl::minstd_rand minstd(seed, offset);
-                oneapi::dpl::ranlux48 ranlux(seed, offset);
-
-                //constexpr double R{1.0};
-                //oneapi::dpl::uniform_real_distribution<double> distr(0.0, R);
-                constexpr uint64_t R{3037000493UL}; // largest prime <= sqrt(ULONG_MAX / 2)
-                oneapi::dpl::uniform_int_distribution<uint64_t> distr(0, R);
-                const auto r_square{R * R};
-
-                auto darts_within_circle{0UL};
-                for (auto i{0UL}; i < number_of_darts; i++) {
-                    const auto x{use_ranlux ? distr(ranlux) : distr(minstd)};
-                    const auto y{use_ranlux ? distr(ranlux) : distr(minstd)};
-                    const auto d_square{x * x + y * y};
-                    if (d_square <= r_square)
-                        darts_within_circle++;
-                }
-                c[index] = darts_within_circle;
-            });
-        });
+        engine.submit(q, c_buf, config);
         // {{UnoAPI:montecarlo-queue-dart-throwing:end}}
 
         // {{UnoAPI:montecarlo-queue-reduce:begin}}
@@ -90,6 +88,17 @@ int main(const int argc, const char *const argv[]) {
     }
     spdlog::info("sum = {}", sum);
 
+    if (verify) {
+        for (auto p{0UL}; p < number_of_players; p++) {
+            const auto darts_within_circle{engine.count(config, p)};
+            if (darts_within_circle != counts[p]) {
+                spdlog::error("result[{}] = {} differs from the sequential count {}", p, counts[p], darts_within_circle);
+                return 1;
+            }
+        }
+        spdlog::info("per-player counts match the sequential loop");
+    }
+
     const double pi{4.0 * sum / (number_of_players * number_of_darts)};
     fmt::print("pi = {}\n", pi);
 
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <CLI/CLI.hpp>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <sycl/sycl.hpp>
+#include <dpc_common.hpp>
+
+#include "darts.h"
+
+// dart throwing throughput of every engine in the registry:
+// one warm-up run, then darts/s at the minimum time (the peak rate), the median time, and the 99th percentile time
+// over the repetitions as engine,value rows (named like the rows of cipher_bench)
+
+int main(const int argc, const char *const argv[]) {
+    std::vector<std::string> engine_names;
+    for (const auto &[name, engine] : dart_engines)
+        engine_names.push_back(name);
+    size_t number_of_players{4};
+    uint64_t number_of_darts{10000000};
+    size_t work_group_size{256};
+    uint64_t darts_per_item{0}; // derived from the device unless given
+    unsigned repetitions{5};
+    bool run_cpuonly{false};
+
+    CLI::App app{"Monte Carlo dart throwing benchmark"};
+    app.option_defaults()->always_capture_default(true);
+    app.add_option("-e,--engines", engine_names, "engines to measure")
+        ->check(CLI::IsMember(engine_names));
+    app.add_option("-p,--players", number_of_players, "number of players")
+        ->check(CLI::PositiveNumber);
+    app.add_option("-n,--darts", number_of_darts, "number of darts per player")
+        ->check(CLI::PositiveNumber);
+    app.add_option("-w,--work-group-size", work_group_size, "work items per work-group of the minstd, philox and mcg59 kernels")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--darts-per-item", darts_per_item, "darts thrown by each work item of the minstd, philox and mcg59 kernels (default: enough work-groups for several per compute unit)")
+        ->check(CLI::PositiveNumber);
+    app.add_option("-r,--repetitions", repetitions, "timed repetitions per engine (after one warm-up run)")
+        ->check(CLI::PositiveNumber);
+    app.add_flag("-c,--cpu-only", run_cpuonly);
+    CLI11_PARSE(app, argc, argv);
+
+    sycl::queue q{run_cpuonly ? sycl::device{sycl::cpu_selector_v} : sycl::device{sycl::default_selector_v},
+                  dpc_common::exception_handler};
+    spdlog::info("Device: {}", q.get_device().get_info<sycl::info::device::name>());
+    spdlog::info("{} players are going to throw {} darts each", number_of_players, number_of_darts);
+
+    const dart_config config{0, number_of_players, number_of_darts, work_group_size, darts_per_item};
+    const double darts{static_cast<double>(number_of_players) * number_of_darts};
+    sycl::buffer<uint64_t> c_buf{sycl::range<1>(number_of_players)};
+
+    for (const auto &name : engine_names) {
+        const auto &engine{dart_engines.at(name)};
+        engine.submit(q, c_buf, config);
+        q.wait();
+
+        std::vector<double> seconds;
+        for (auto r{0U}; r < repetitions; r++) {
+            const auto start{std::chrono::steady_clock::now()};
+            engine.submit(q, c_buf, config);
+            q.wait();
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(seconds.begin(), seconds.end());
+
+        uint64_t sum{0};
+        const sycl::host_accessor c{c_buf};
+        for (auto p{0UL}; p < number_of_players; p++)
+            sum += c[p];
+        spdlog::info("{}: pi = {}", name, 4.0 * sum / darts);
+        fmt::print("{} max darts/s,{}\n", name, darts / seconds.front());
+        fmt::print("{} median darts/s,{}\n", name, darts / seconds[seconds.size() / 2]);
+        fmt::print("{} p99-time darts/s,{}\n", name, darts / seconds[static_cast<size_t>(std::ceil(0.99 * seconds.size())) - 1]);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <array>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011).
+// A block of four 32-bit words is a pure function of a 128-bit counter and a 64-bit key,
+// so any dart can be drawn on its own: the key is the seed, and the counter is (dart index, player).
+// Only 32-bit integer multiplies are used, so every device yields the same bits.
+class philox4x32 {
+public:
+    using counter_type = std::array<uint32_t, 4>;
+    using key_type = std::array<uint32_t, 2>;
+
+    explicit philox4x32(const uint64_t seed)
+        : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+    counter_type operator()(counter_type counter) const {
+        auto k{key};
+        for (auto round{0}; round < 10; round++) {
+            if (round > 0) {
+                k[0] += W0;
+                k[1] += W1;
+            }
+            const uint64_t product_0{static_cast<uint64_t>(M0) * counter[0]};
+            const uint64_t product_1{static_cast<uint64_t>(M1) * counter[2]};
+            counter = {
+                static_cast<uint32_t>(product_1 >> 32) ^ counter[1] ^ k[0],
+                static_cast<uint32_t>(product_1),
+                static_cast<uint32_t>(product_0 >> 32) ^ counter[3] ^ k[1],
+                static_cast<uint32_t>(product_0)
+            };
+        }
+        return counter;
+    }
+
+    // the two 64-bit halves of the block for one dart of one player
+    std::array<uint64_t, 2> operator()(const uint64_t dart, const uint64_t player) const {
+        const auto block = (*this)(counter_type{
+            static_cast<uint32_t>(dart), static_cast<uint32_t>(dart >> 32),
+            static_cast<uint32_t>(player), static_cast<uint32_t>(player >> 32)
+        });
+        return {
+            (static_cast<uint64_t>(block[1]) << 32) | block[0],
+            (static_cast<uint64_t>(block[3]) << 32) | block[2]
+        };
+    }
+
+private:
+    static constexpr uint32_t M0{0xD2511F53};
+    static constexpr uint32_t M1{0xCD9E8D57};
+    static constexpr uint32_t W0{0x9E3779B9};
+    static constexpr uint32_t W1{0xBB67AE85};
+    key_type key;
+};
+
+// maps 64 uniform bits to [0, bound) as the high word of bits * bound (bound < 2^32),
+// without 128-bit integers, which not every device compiler supports
+inline uint64_t scale_to(const uint64_t bits, const uint64_t bound) {
+    const auto high{(bits >> 32) * bound};
+    const auto low{(bits & 0xFFFFFFFFUL) * bound};
+    return (high + (low >> 32)) >> 32;
+}
+
+#endif
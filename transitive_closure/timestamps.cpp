@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdio>
 #include <fmt/format.h>
 #include <sycl/sycl.hpp>
@@ -16,4 +17,29 @@ void print_timestamps(std::vector<std::tuple<std::string, double>> & timestamps)
         fmt::print("{},{}", std::get<0>(tuple), std::get<1>(tuple));
         fmt::print("\n");
     });
-}
\ No newline at end of file
+}
+
+// event times -> using sycl event profiling
+double mark_event_times(std::vector<std::tuple<std::string, double>> & timestamps, const std::vector<sycl::event> & events, const std::string_view label) {
+    double queue_wait = 0;
+    double execute = 0;
+    uint64_t first_start = 0;
+    uint64_t previous_end = 0;
+    for (const auto & event : events) {
+        const auto submit = event.get_profiling_info<sycl::info::event_profiling::command_submit>();
+        const auto start = event.get_profiling_info<sycl::info::event_profiling::command_start>();
+        const auto end = event.get_profiling_info<sycl::info::event_profiling::command_end>();
+        if (&event == &events.front()) { first_start = start; }
+        const auto ready = std::max<uint64_t>(submit, previous_end);
+        queue_wait += start > ready ? start - ready : 0;
+        execute += end - start;
+        previous_end = std::max<uint64_t>(previous_end, end);
+    }
+    mark_time(timestamps, queue_wait, std::string(label) + " queue wait");
+    mark_time(timestamps, execute, std::string(label) + " execute");
+    if (events.size() > 1) {
+        double span = previous_end - first_start;
+        mark_time(timestamps, span, std::string(label) + " span");
+    }
+    return execute;
+}
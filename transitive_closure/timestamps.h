@@ -1,6 +1,8 @@
 #ifndef CIPHER_TIMESTAMPS_H
 #define CIPHER_TIMESTAMPS_H
 
+#include <sycl/sycl.hpp>
+
 #include <vector>
 #include <unordered_map>
 #include <chrono>
@@ -11,4 +13,12 @@ void mark_time(std::vector<std::tuple<std::string, double>> & timestamps, double
 // print_timestamps using nanotimer
 void print_timestamps(std::vector<std::tuple<std::string, double>> & timestamps);
 
+// mark_event_times using SYCL event profiling (the queue needs sycl::property::queue::enable_profiling):
+// "<label> execute" from command_start to command_end, summed over the events, and "<label> queue wait",
+// the time each event waited to start after its command_submit or after the end of the previous event,
+// whichever is later (so that a chain of kernels on an in-order queue does not count earlier kernels as wait);
+// for several events also "<label> span" from the first command_start to the last command_end;
+// returns the execute time
+double mark_event_times(std::vector<std::tuple<std::string, double>> & timestamps, const std::vector<sycl::event> & events, std::string_view label);
+
 #endif
\ No newline at end of file
@@ -179,20 +179,13 @@ int main(const int argc, const char *const argv[])
     // run parallel::begin
     else {
         spdlog::info("starting parallel execution block");
-        // flag buffer for timing parallel execution
-        spdlog::info("initializing flag");
-        plf::nanotimer time_flag_init;
-        time_flag_init.start();
-        sycl::buffer<int> flag_buf{sycl::range<1>{1}};
-        time_result = time_flag_init.get_elapsed_ns();
-        mark_time(timestamps, time_result, "init flag buf");
         
         // sycl queue creation::begin
         spdlog::info("setting up queue");
         plf::nanotimer time_device_init;
         time_device_init.start();
         sycl::device device{run_cpuonly ? sycl::cpu_selector_v : sycl::default_selector_v};
-        sycl::queue q{device, dpc_common::exception_handler, sycl::property::queue::in_order()};
+        sycl::queue q{device, dpc_common::exception_handler, sycl::property_list{sycl::property::queue::in_order(), sycl::property::queue::enable_profiling()}};
         device_name = q.get_device().get_info<sycl::info::device::name>();
         spdlog::info("device: {}", device_name);
         time_result = time_device_init.get_elapsed_ns();
@@ -205,7 +198,11 @@ int main(const int argc, const char *const argv[])
         //   for j := 1 to n do
         //     A[i, j] := C[i, j]
         //
-        q.submit([&](auto &h) {
+        // note: The events of the kernels are kept for their profiling info.
+        //
+        plf::nanotimer time_submit_p1;
+        time_submit_p1.start();
+        const auto step_1 = q.submit([&](auto &h) {
             const sycl::accessor C(C_buf, h, sycl::read_only);
             const sycl::accessor A(A_buf, h, sycl::write_only);
 
@@ -214,6 +211,8 @@ int main(const int argc, const char *const argv[])
 
             });
         });
+        time_result = time_submit_p1.get_elapsed_ns();
+        mark_time(timestamps, time_result, "Warshall procedure step 1 submit");
 
         // Warshall procedure
         // step 2: compute the transitive closure of C as A
@@ -226,25 +225,36 @@ int main(const int argc, const char *const argv[])
         //
         // note: A[index] = A[i][j]
         //
+        plf::nanotimer time_submit_p2;
+        time_submit_p2.start();
+        std::vector<sycl::event> step_2;
         for (int k = 0; k < n; k++) {
 
-            q.submit([&](auto &h) {
+            step_2.push_back(q.submit([&](auto &h) {
                 const sycl::accessor A(A_buf, h, sycl::write_only);
                 
                 h.parallel_for(sycl::range(n, n), [=](auto index) {
                     A[index] = A[index] || A[index[0]][k] * A[k][index[1]];
 
                 });
-            });
+            }));
         }
-        // access flag buff to initiate work on device::begin
-        spdlog::info("preparing flag access");
+        time_result = time_submit_p2.get_elapsed_ns();
+        mark_time(timestamps, time_result, "Warshall procedure step 2 submit");
+        
+        // wait for the kernels on device::begin
+        spdlog::info("waiting for the Warshall procedure");
         plf::nanotimer time_parallel;
         time_parallel.start();
-        const sycl::host_accessor flag{flag_buf};
+        q.wait();
         time_result = time_parallel.get_elapsed_ns();
-        mark_time(timestamps, time_result, "Warshall procedure step 1 & 2");
-        // access flag buff to initiate work on device::end
+        mark_time(timestamps, time_result, "Warshall procedure step 1 & 2 host wait");
+        // wait for the kernels on device::end
+        
+        // kernel profiling::begin
+        mark_event_times(timestamps, {step_1}, "Warshall procedure step 1");
+        mark_event_times(timestamps, step_2, "Warshall procedure step 2");
+        // kernel profiling::end
         
         if (print) {
             const sycl::host_accessor A{A_buf};